@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// Helpers shared by the microbenchmarks. Each benchmark is its own program
+// linked against LoxRuntime, built with -DLOX_BENCHMARKS=ON.
+
+// Milliseconds taken by one call of f.
+template <typename F> double millis(F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+// The best of rounds timings of f, the one least disturbed by anything
+// else running.
+template <typename F> double bestMillis(int rounds, F &&f) {
+  double best = millis(f);
+
+  for (int i = 1; i < rounds; i++) {
+    double time = millis(f);
+    best = time < best ? time : best;
+  }
+
+  return best;
+}
+
+// Bytes in use on the heap, or 0 where malloc can't tell.
+inline size_t heapBytes() {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+// Keeps the compiler from optimizing away a result.
+template <typename T> void keep(const T &value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
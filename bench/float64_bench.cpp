@@ -0,0 +1,72 @@
+#include "bench.hpp"
+#include "float64_kernels.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Each Float64Array kernel in the build the processor gets against the
+// scalar build, on arrays of n doubles, repeated to about 400M elements.
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+  size_t repeats = 400000000 / n + 1;
+  std::mt19937_64 random(42);
+  std::vector<double> a(n), b(n), c(n), out(n);
+
+  for (size_t i = 0; i < n; i++) {
+    a[i] = static_cast<double>(random() % 1000000) / 1000;
+    b[i] = static_cast<double>(random() % 1000000) / 1000;
+    c[i] = static_cast<double>(random() % 1000000) / 1000;
+  }
+
+  const Float64Kernels &best = float64Kernels();
+  const Float64Kernels &scalar = scalarFloat64Kernels();
+
+  if (&best == &scalar)
+    std::printf("No AVX2 and FMA here: both columns are scalar.\n");
+
+  auto measure = [&](const char *name, auto kernel) {
+    double fast = bestMillis(3, [&] {
+      for (size_t r = 0; r < repeats; r++) {
+        kernel(best);
+      }
+    });
+
+    double slow = bestMillis(3, [&] {
+      for (size_t r = 0; r < repeats; r++) {
+        kernel(scalar);
+      }
+    });
+
+    std::printf("%-6s %8.1f ms  scalar %8.1f ms  %4.1fx\n", name, fast, slow,
+                slow / fast);
+  };
+
+  measure("add", [&](const Float64Kernels &k) {
+    k.add(a.data(), b.data(), out.data(), n);
+    keep(out);
+  });
+  measure("mul", [&](const Float64Kernels &k) {
+    k.mul(a.data(), b.data(), out.data(), n);
+    keep(out);
+  });
+  measure("fma", [&](const Float64Kernels &k) {
+    k.fma(a.data(), b.data(), c.data(), out.data(), n);
+    keep(out);
+  });
+  measure("scale", [&](const Float64Kernels &k) {
+    k.scale(a.data(), 1.5, out.data(), n);
+    keep(out);
+  });
+  measure("sqrt", [&](const Float64Kernels &k) {
+    k.sqrt(a.data(), out.data(), n);
+    keep(out);
+  });
+  measure("sum", [&](const Float64Kernels &k) { keep(k.sum(a.data(), n)); });
+  measure("dot", [&](const Float64Kernels &k) {
+    keep(k.dot(a.data(), b.data(), n));
+  });
+  measure("min", [&](const Float64Kernels &k) { keep(k.min(a.data(), n)); });
+  measure("max", [&](const Float64Kernels &k) { keep(k.max(a.data(), n)); });
+}
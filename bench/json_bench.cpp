@@ -0,0 +1,91 @@
+#include "bench.hpp"
+#include "error_reporter.hpp"
+#include "interpreter.hpp"
+#include "lox_json.hpp"
+#include "lox_string.hpp"
+#include "options.hpp"
+#include "output.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+// jsonParse and jsonStringify in MB/s on two generated documents: an array
+// of small records, where the time goes into building maps, and an array
+// of long strings, where it goes into scanning them.
+
+ErrorReporter errorReporter{};
+Options options{};
+Output output{};
+
+static std::string records(size_t count) {
+  std::mt19937_64 random(42);
+  std::string json = "[";
+
+  for (size_t i = 0; i < count; i++) {
+    json += i == 0 ? "" : ",";
+    json += "{\"id\":" + std::to_string(i) + ",\"name\":\"user " +
+            std::to_string(random() % 100000) + "\",\"email\":\"user" +
+            std::to_string(i) + "@example.com\",\"active\":" +
+            (random() % 2 ? "true" : "false") +
+            ",\"score\":" + std::to_string(random() % 10000 / 100.0) +
+            ",\"tags\":[\"alpha\",\"beta\",\"gamma\"],\"address\":{"
+            "\"street\":\"" +
+            std::to_string(random() % 1000) +
+            " Main Street\",\"city\":\"Springfield\",\"zip\":\"" +
+            std::to_string(10000 + random() % 90000) + "\"}}";
+  }
+
+  return json + "]";
+}
+
+static std::string strings(size_t count, size_t length) {
+  std::mt19937_64 random(42);
+  std::string json = "[";
+
+  for (size_t i = 0; i < count; i++) {
+    json += i == 0 ? "\"" : ",\"";
+
+    for (size_t j = 0; j < length; j++) {
+      json += static_cast<char>('a' + random() % 26);
+    }
+
+    json += "\"";
+  }
+
+  return json + "]";
+}
+
+static void measure(Interpreter &interpreter, const char *name,
+                    const std::string &json) {
+  JsonParseFunc parse{};
+  JsonStringifyFunc stringify{};
+  LiteralObject text = std::make_shared<LoxString>(json);
+  LiteralObject value{};
+  double megabytes = json.size() / 1e6;
+
+  // The previous document is freed outside the timing.
+  double parseMillis = 0;
+
+  for (int round = 0; round < 3; round++) {
+    value = std::monostate{};
+    double time = millis([&] { value = parse.call(interpreter, {text}); });
+    parseMillis = round == 0 || time < parseMillis ? time : parseMillis;
+  }
+
+  double stringifyMillis =
+      bestMillis(3, [&] { keep(stringify.call(interpreter, {value})); });
+
+  std::printf("%-8s %5.1f MB  parse %6.0f ms (%4.0f MB/s)  "
+              "stringify %6.0f ms (%4.0f MB/s)\n",
+              name, megabytes, parseMillis, megabytes * 1e3 / parseMillis,
+              stringifyMillis, megabytes * 1e3 / stringifyMillis);
+}
+
+int main(int argc, char *argv[]) {
+  size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 250000;
+  Interpreter interpreter{};
+
+  measure(interpreter, "records", records(count));
+  measure(interpreter, "strings", strings(count / 5, 1100));
+}
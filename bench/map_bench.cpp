@@ -0,0 +1,76 @@
+#include "bench.hpp"
+#include "error_reporter.hpp"
+#include "lox_map.hpp"
+#include "options.hpp"
+#include "output.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+// LoxMap against std::unordered_map with the same hash and key equality:
+// inserting n number keys, looking each of them up, and the heap bytes per
+// entry once they are all in.
+
+ErrorReporter errorReporter{};
+Options options{};
+Output output{};
+
+struct KeyHash {
+  size_t operator()(const LiteralObject &key) const {
+    return LoxMap::hashKey(key);
+  }
+};
+
+struct KeyEqual {
+  bool operator()(const LiteralObject &a, const LiteralObject &b) const {
+    return LoxMap::keysEqual(a, b);
+  }
+};
+
+using StdMap =
+    std::unordered_map<LiteralObject, LiteralObject, KeyHash, KeyEqual>;
+
+template <typename Map, typename Set, typename Find>
+static void measure(const char *name, size_t n, Set set, Find find) {
+  double insert = 0;
+  double lookup = 0;
+  size_t bytes = 0;
+
+  {
+    Map map{};
+    size_t before = heapBytes();
+    insert = millis([&] {
+      for (size_t i = 0; i < n; i++) {
+        set(map, static_cast<double>(i), static_cast<double>(i));
+      }
+    });
+    bytes = heapBytes() - before;
+
+    lookup = millis([&] {
+      double sum = 0;
+
+      for (size_t i = 0; i < n; i++) {
+        sum += std::get<double>(*find(map, static_cast<double>(i)));
+      }
+
+      keep(sum);
+    });
+  }
+
+  std::printf("%-14s insert %7.1f ms  lookup %7.1f ms  %5.1f bytes/entry\n",
+              name, insert, lookup, static_cast<double>(bytes) / n);
+}
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+  measure<LoxMap>(
+      "LoxMap", n,
+      [](LoxMap &map, double key, double value) { map.set(key, value); },
+      [](LoxMap &map, double key) { return map.find(key); });
+
+  measure<StdMap>(
+      "unordered_map", n,
+      [](StdMap &map, double key, double value) { map[key] = value; },
+      [](StdMap &map, double key) { return &map.find(key)->second; });
+}
@@ -0,0 +1,56 @@
+#include "bench.hpp"
+#include "number_format.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// formatNumber against std::to_string, which numbers printed through
+// before: integers and fractions, written into a buffer and into the
+// std::string StringifyLiteralVisitor returns.
+
+static void measure(const char *name, const std::vector<double> &values) {
+  size_t n = values.size();
+
+  double toString = bestMillis(5, [&] {
+    for (double value : values) {
+      keep(std::to_string(value));
+    }
+  });
+
+  double buffer = bestMillis(5, [&] {
+    char chars[NUMBER_BUFFER_SIZE];
+
+    for (double value : values) {
+      keep(formatNumber(value, chars));
+    }
+  });
+
+  double string = bestMillis(5, [&] {
+    char chars[NUMBER_BUFFER_SIZE];
+
+    for (double value : values) {
+      keep(std::string(chars, formatNumber(value, chars)));
+    }
+  });
+
+  std::printf("%-10s std::to_string %5.1f ns  formatNumber %5.1f ns  "
+              "(%5.1f ns into a std::string)\n",
+              name, toString * 1e6 / n, buffer * 1e6 / n, string * 1e6 / n);
+}
+
+int main(int argc, char *argv[]) {
+  size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  std::mt19937_64 random(42);
+  std::vector<double> integers(n);
+  std::vector<double> fractions(n);
+
+  for (size_t i = 0; i < n; i++) {
+    integers[i] = static_cast<double>(random() % 100000000);
+    fractions[i] = static_cast<double>(random() % 100000000) / 7;
+  }
+
+  measure("integers", integers);
+  measure("fractions", fractions);
+}
@@ -0,0 +1,93 @@
+#include "bench.hpp"
+#include "error_reporter.hpp"
+#include "lox_string.hpp"
+#include "options.hpp"
+#include "output.hpp"
+#include "string_kernels.hpp"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+
+// The string kernels against the standard library on a block of text:
+// findBytes for a needle that never occurs, so the whole text is scanned,
+// toUpperBytes and toLowerBytes against a std::toupper/std::tolower loop,
+// and a 1 KB substring taken as a slice against copying it.
+
+ErrorReporter errorReporter{};
+Options options{};
+Output output{};
+
+static void report(const char *name, double megabytes, double kernel,
+                   const char *baselineName, double baseline) {
+  std::printf("%-14s %6.0f MB/s   %-22s %6.0f MB/s\n", name,
+              megabytes * 1e3 / kernel, baselineName,
+              megabytes * 1e3 / baseline);
+}
+
+int main(int argc, char *argv[]) {
+  size_t size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64) << 20;
+  std::mt19937_64 random(42);
+  std::string text(size, ' ');
+
+  for (char &c : text) {
+    uint64_t r = random() % 32;
+    c = r < 26 ? static_cast<char>((r % 2 ? 'a' : 'A') + r) : ' ';
+  }
+
+  double megabytes = size / 1e6;
+  std::string_view needle = "needle!";
+  std::string out(size, '\0');
+
+  report("findBytes", megabytes,
+         bestMillis(5, [&] { keep(findBytes(text, needle)); }),
+         "string_view::find",
+         bestMillis(5, [&] { keep(std::string_view(text).find(needle)); }));
+
+  report("toUpperBytes", megabytes,
+         bestMillis(5, [&] { toUpperBytes(text.data(), out.data(), size); }),
+         "std::toupper loop", bestMillis(5, [&] {
+           for (size_t i = 0; i < size; i++) {
+             out[i] = static_cast<char>(
+                 std::toupper(static_cast<unsigned char>(text[i])));
+           }
+
+           keep(out);
+         }));
+
+  report("toLowerBytes", megabytes,
+         bestMillis(5, [&] { toLowerBytes(text.data(), out.data(), size); }),
+         "std::tolower loop", bestMillis(5, [&] {
+           for (size_t i = 0; i < size; i++) {
+             out[i] = static_cast<char>(
+                 std::tolower(static_cast<unsigned char>(text[i])));
+           }
+
+           keep(out);
+         }));
+
+  auto string = std::make_shared<LoxString>(text);
+  string->view();
+  constexpr size_t SUBSTRINGS = 1000000;
+  constexpr size_t LENGTH = 1024;
+  size_t span = size - LENGTH;
+
+  double slice = bestMillis(5, [&] {
+    for (size_t i = 0; i < SUBSTRINGS; i++) {
+      keep(LoxString::substr(string, i * 4099 % span, LENGTH));
+    }
+  });
+
+  double copy = bestMillis(5, [&] {
+    for (size_t i = 0; i < SUBSTRINGS; i++) {
+      keep(std::make_shared<LoxString>(
+          std::string(string->view().substr(i * 4099 % span, LENGTH))));
+    }
+  });
+
+  std::printf("substr of 1 KB %6.1f ns as a slice, %6.1f ns as a copy\n",
+              slice * 1e6 / SUBSTRINGS, copy * 1e6 / SUBSTRINGS);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "environment.hpp"
+#include "interpreter.hpp"
+#include "lox_callable.hpp"
+#include "token.hpp"
+#include "token_type.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+// A Lox function compiled ahead of time by CppEmitter: a C++ function taking
+// the environment the declaration closed over and the arguments. A tail call
+// to another AotFunction is handed back through interpreter.tailCallee and
+// run by call() in place of the returning function, as LoxFunc does.
+class AotFunction : public LoxCallable {
+public:
+  using Body = LiteralObject (*)(Interpreter &interpreter,
+                                 const std::shared_ptr<Environment> &closure,
+                                 std::vector<LiteralObject> &args);
+
+  AotFunction(std::string name, int params, Body body,
+              std::shared_ptr<Environment> closure);
+
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+
+private:
+  std::string name;
+  int params;
+  Body body;
+  std::shared_ptr<Environment> closure;
+};
+
+// What the C++ generated by --emit-cpp is made of. Each operation does what
+// the interpreter does for the corresponding node, down to the runtime
+// errors, so a compiled script prints exactly what it would interpreted.
+// Generated code evaluates operands into temporaries first, in the
+// interpreter's order, and passes them here.
+class AotRuntime {
+public:
+  // Runs a compiled script with the interpreter's natives defined and
+  // reports a runtime error the way the interpreter does.
+  static int main(void (*script)(Interpreter &interpreter));
+
+  static LiteralObject number(uint64_t bits);
+
+  static LiteralObject string(const char *chars, size_t length);
+
+  static bool truthy(const LiteralObject &value) {
+    return std::visit(TruthyLiteralVisitor{}, value);
+  }
+
+  static LiteralObject negate(const Token &op, const LiteralObject &value);
+
+  template <TokenType OP>
+  static LiteralObject binary(const Token &op, const LiteralObject &left,
+                              const LiteralObject &right) {
+    const double *a = std::get_if<double>(&left);
+    const double *b = std::get_if<double>(&right);
+
+    if (a == nullptr || b == nullptr)
+      return Interpreter::genericOp<OP>(op, left, right);
+
+    if constexpr (OP == TokenType::PLUS)
+      return *a + *b;
+    else if constexpr (OP == TokenType::MINUS)
+      return *a - *b;
+    else if constexpr (OP == TokenType::STAR)
+      return *a * *b;
+    else if constexpr (OP == TokenType::SLASH)
+      return *a / *b;
+    else if constexpr (OP == TokenType::GREATER)
+      return *a > *b;
+    else if constexpr (OP == TokenType::GREATER_EQUAL)
+      return *a >= *b;
+    else if constexpr (OP == TokenType::LESS)
+      return *a < *b;
+    else if constexpr (OP == TokenType::LESS_EQUAL)
+      return *a <= *b;
+    else if constexpr (OP == TokenType::EQUAL_EQUAL)
+      return *a == *b;
+    else
+      return *a != *b;
+  }
+
+  static LiteralObject call(Interpreter &interpreter, const Token &paren,
+                            const LiteralObject &callee,
+                            std::vector<LiteralObject> args);
+
+  // A call in tail position: AotFunctions are left to the caller's
+  // AotFunction::call, anything else is called right away.
+  static LiteralObject tailCall(Interpreter &interpreter, const Token &paren,
+                                const LiteralObject &callee,
+                                std::vector<LiteralObject> args);
+
+  static LiteralObject function(std::string name, int params,
+                                AotFunction::Body body,
+                                std::shared_ptr<Environment> closure);
+
+  static LiteralObject klass(std::string name);
+
+  static LiteralObject get(const Token &name, const LiteralObject &object);
+
+  // Set checks its object before its value is evaluated.
+  static void checkFields(const Token &name, const LiteralObject &object);
+
+  static void set(const Token &name, const LiteralObject &object,
+                  const LiteralObject &value);
+
+  static LiteralObject list(std::vector<LiteralObject> elements);
+
+  static LiteralObject index(const Token &bracket, const LiteralObject &object,
+                             const LiteralObject &index);
+
+  // SetIndex checks its object and index before its value is evaluated.
+  static void checkIndexed(const Token &bracket, const LiteralObject &object,
+                           const LiteralObject &index);
+
+  static void setIndex(const Token &bracket, const LiteralObject &object,
+                       const LiteralObject &index, const LiteralObject &value);
+
+  static void print(const LiteralObject &value);
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "expr.hpp"
+#include "stmt.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Walks a program, counting its nodes and checking the structural
+// invariants the interpreter relies on: required children are present and
+// every variable reference has been resolved. Used by the PassManager to
+// measure and sanity-check each pass.
+class AstVerifier {
+private:
+  void check(std::shared_ptr<Stmt> stmt, std::string what);
+
+  void check(std::shared_ptr<Expr> expr, std::string what);
+
+  void checkResolved(const std::optional<size_t> &id, const Token &name);
+
+public:
+  size_t nodes{0};
+  std::vector<std::string> errors{};
+
+  void verify(std::vector<std::shared_ptr<Stmt>> &statements);
+
+  void operator()(Block &stmt);
+
+  void operator()(Class &stmt);
+
+  void operator()(Expression &stmt);
+
+  void operator()(Func &stmt);
+
+  void operator()(If &stmt);
+
+  void operator()(Print &stmt);
+
+  void operator()(Return &stmt);
+
+  void operator()(Var &stmt);
+
+  void operator()(While &stmt);
+
+  void operator()(Assign &expr);
+
+  void operator()(Logical &expr);
+
+  void operator()(Binary &expr);
+
+  void operator()(Call &expr);
+
+  void operator()(Get &expr);
+
+  void operator()(Set &expr);
+
+  void operator()(Grouping &expr);
+
+  void operator()(Literal &expr);
+
+  void operator()(Unary &expr);
+
+  void operator()(Variable &expr);
+
+  void operator()(ListLiteral &expr);
+
+  void operator()(Index &expr);
+
+  void operator()(SetIndex &expr);
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "expr.hpp"
+#include "pass.hpp"
+#include "stmt.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Evaluates operators whose operands are all literals ahead of time, and
+// drops the untaken branch of an if or while with a literal condition.
+// Expressions that would raise a runtime error are left alone so the error
+// still happens at the same point when the program runs.
+//
+// Each visitor returns the node that should replace the visited one, or
+// nullptr to keep it.
+class ConstantFolding : public Pass {
+private:
+  size_t foldedExprs{0};
+  size_t removedBranches{0};
+
+  void fold(std::shared_ptr<Stmt> &stmt);
+  void fold(std::shared_ptr<Expr> &expr);
+  void fold(std::vector<std::shared_ptr<Stmt>> &statements);
+
+  static const LiteralObject *constant(const std::shared_ptr<Expr> &expr);
+  std::shared_ptr<Expr> literal(LiteralObject value);
+
+public:
+  std::string name() const override;
+
+  void run(std::vector<std::shared_ptr<Stmt>> &statements) override;
+
+  void report(std::ostream &out) const override;
+
+  std::shared_ptr<Stmt> operator()(Block &stmt);
+
+  std::shared_ptr<Stmt> operator()(Class &stmt);
+
+  std::shared_ptr<Stmt> operator()(Expression &stmt);
+
+  std::shared_ptr<Stmt> operator()(Func &stmt);
+
+  std::shared_ptr<Stmt> operator()(If &stmt);
+
+  std::shared_ptr<Stmt> operator()(Print &stmt);
+
+  std::shared_ptr<Stmt> operator()(Return &stmt);
+
+  std::shared_ptr<Stmt> operator()(Var &stmt);
+
+  std::shared_ptr<Stmt> operator()(While &stmt);
+
+  std::shared_ptr<Expr> operator()(Assign &expr);
+
+  std::shared_ptr<Expr> operator()(Logical &expr);
+
+  template <TokenType OP> std::shared_ptr<Expr> operator()(BinaryOp<OP> &expr);
+
+  std::shared_ptr<Expr> operator()(Call &expr);
+
+  std::shared_ptr<Expr> operator()(Get &expr);
+
+  std::shared_ptr<Expr> operator()(Set &expr);
+
+  std::shared_ptr<Expr> operator()(Grouping &expr);
+
+  std::shared_ptr<Expr> operator()(Literal &expr);
+
+  std::shared_ptr<Expr> operator()(Unary &expr);
+
+  std::shared_ptr<Expr> operator()(Variable &expr);
+
+  std::shared_ptr<Expr> operator()(ListLiteral &expr);
+
+  std::shared_ptr<Expr> operator()(Index &expr);
+
+  std::shared_ptr<Expr> operator()(SetIndex &expr);
+};
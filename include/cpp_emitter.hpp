@@ -0,0 +1,143 @@
+#pragma once
+
+#include "expr.hpp"
+#include "interpreter.hpp"
+#include "stmt.hpp"
+#include "token.hpp"
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Translates a resolved program to C++ that links against the LoxRuntime
+// library (see AotRuntime), for --emit-cpp. Every Lox function becomes a C++
+// function and every expression a sequence of temporaries evaluated in the
+// interpreter's order.
+//
+// Locals no nested function refers to become C++ locals. The others, and the
+// parameters among them, live in an Environment created for their scope as
+// the interpreter would, so closures see them; scopes without such
+// variables get no environment at all. Globals stay in interpreter.globals.
+//
+// The program is translated twice: the first run only finds the locals
+// nested functions capture.
+class CppEmitter {
+private:
+  struct Binding {
+    const void *decl;
+    std::string name;
+    size_t function;
+    int env;
+  };
+
+  struct Scope {
+    std::unordered_map<std::string, Binding> bindings{};
+    int env;
+  };
+
+  struct Env {
+    std::string name;
+    size_t function;
+  };
+
+  Interpreter &interpreter;
+  std::unordered_set<const void *> captured{};
+
+  std::vector<Scope> scopes{};
+  std::vector<Env> environments{};
+  std::vector<int> closures{};
+
+  std::ostringstream *out{nullptr};
+  int indent{0};
+  size_t temps{0};
+  size_t variables{0};
+  std::vector<std::string> functions{};
+
+  std::map<std::tuple<int, std::string, int>, size_t> tokens{};
+  std::map<std::string, size_t> strings{};
+
+  void line(const std::string &text);
+  std::string temp(const std::string &value);
+  std::string token(const Token &token);
+  std::string literal(const LiteralObject &value);
+  static std::string quote(const std::string &chars);
+
+  size_t function() const;
+  bool isLocal(const std::optional<size_t> &id) const;
+  const Binding *lookUp(const std::string &name);
+  std::string environment(const Binding &binding, int &distance) const;
+  std::string currentEnvironment() const;
+
+  bool needsEnvironment(const std::vector<std::shared_ptr<Stmt>> &statements,
+                        const Func *params) const;
+  void beginScope(bool environment);
+  void endScope();
+  void declare(const void *decl, const Token &name);
+  void initialize(const Token &name, const std::string &value);
+  std::string load(const Token &name, const std::optional<size_t> &id);
+  void store(const Token &name, const std::optional<size_t> &id,
+             const std::string &value);
+
+  std::string emit(Expr &expr);
+  void emit(Stmt &stmt);
+  std::string emitFunction(Func &func);
+  std::string emitArgs(std::vector<std::shared_ptr<Expr>> &args);
+  void translate(std::vector<std::shared_ptr<Stmt>> &statements,
+                 std::ostringstream &script);
+
+public:
+  CppEmitter(Interpreter &interpreter);
+
+  void emit(std::vector<std::shared_ptr<Stmt>> &statements,
+            std::ostream &output);
+
+  std::string operator()(Assign &expr);
+
+  std::string operator()(Logical &expr);
+
+  template <TokenType OP> std::string operator()(BinaryOp<OP> &expr);
+
+  std::string operator()(Call &expr);
+
+  std::string operator()(Get &expr);
+
+  std::string operator()(Set &expr);
+
+  std::string operator()(Grouping &expr);
+
+  std::string operator()(Literal &expr);
+
+  std::string operator()(Unary &expr);
+
+  std::string operator()(Variable &expr);
+
+  std::string operator()(ListLiteral &expr);
+
+  std::string operator()(Index &expr);
+
+  std::string operator()(SetIndex &expr);
+
+  void operator()(Block &stmt);
+
+  void operator()(Class &stmt);
+
+  void operator()(Expression &stmt);
+
+  void operator()(Func &stmt);
+
+  void operator()(If &stmt);
+
+  void operator()(Print &stmt);
+
+  void operator()(Return &stmt);
+
+  void operator()(Var &stmt);
+
+  void operator()(While &stmt);
+};
@@ -14,10 +14,16 @@ public:
   Environment();
   Environment(std::shared_ptr<Environment> enclosing);
 
-  void define(std::string name, LiteralObject value);
-  void assign(Token name, LiteralObject value);
-  void assignAt(int distance, Token name, LiteralObject value);
-  LiteralObject get(Token name);
-  LiteralObject getAt(int distance, Token name);
+  void define(const std::string &name, LiteralObject value);
+  void assign(const Token &name, LiteralObject value);
+  void assignAt(int distance, const Token &name, LiteralObject value);
+  LiteralObject get(const Token &name);
+  LiteralObject getAt(int distance, const Token &name);
   Environment *ancestor(int distance);
+
+  // Reuses this environment for another activation under a new parent.
+  // The previous activation's values are released at once, though their
+  // names stay until redefined; resolution guarantees they are never read
+  // before that.
+  void reset(std::shared_ptr<Environment> enclosing);
 };
@@ -2,11 +2,18 @@
 
 #include "runtime_error.hpp"
 #include "token.hpp"
+#include <atomic>
+#include <mutex>
 #include <string>
 
+// Safe to call from several threads: modules are scanned, parsed and
+// resolved in parallel.
 class ErrorReporter {
+private:
+  std::mutex mutex{};
+
 public:
-  bool hadError{false};
+  std::atomic<bool> hadError{false};
   bool hadRuntimeError{false};
 
   void reportError(int line, std::string where, std::string message);
@@ -14,4 +21,8 @@ public:
   void error(Token token, std::string message);
 
   void runtimeError(RuntimeError *error);
+
+  // Errors reported so far from the calling thread, so a thread compiling a
+  // module can tell whether that module failed.
+  static size_t threadErrors();
 };
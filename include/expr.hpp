@@ -1,6 +1,7 @@
 #pragma once
 
 #include "token.hpp"
+#include "token_type.hpp"
 #include <memory>
 #include <optional>
 #include <variant>
@@ -8,7 +9,7 @@
 
 struct Assign;
 struct Logical;
-struct Binary;
+template <TokenType OP> struct BinaryOp;
 struct Call;
 struct Get;
 struct Set;
@@ -16,9 +17,28 @@ struct Grouping;
 struct Literal;
 struct Unary;
 struct Variable;
-
-using Expr = std::variant<Assign, Logical, Binary, Call, Get, Set, Grouping,
-                          Literal, Unary, Variable>;
+struct ListLiteral;
+struct Index;
+struct SetIndex;
+
+// Binary operators get one node type each, all instantiated from BinaryOp, so
+// the interpreter's evaluator for a node is compiled for its operator and
+// never switches on the operator at runtime.
+using Add = BinaryOp<TokenType::PLUS>;
+using Subtract = BinaryOp<TokenType::MINUS>;
+using Multiply = BinaryOp<TokenType::STAR>;
+using Divide = BinaryOp<TokenType::SLASH>;
+using Greater = BinaryOp<TokenType::GREATER>;
+using GreaterEqual = BinaryOp<TokenType::GREATER_EQUAL>;
+using Less = BinaryOp<TokenType::LESS>;
+using LessEqual = BinaryOp<TokenType::LESS_EQUAL>;
+using Equal = BinaryOp<TokenType::EQUAL_EQUAL>;
+using NotEqual = BinaryOp<TokenType::BANG_EQUAL>;
+
+using Expr = std::variant<Assign, Logical, Add, Subtract, Multiply, Divide,
+                          Greater, GreaterEqual, Less, LessEqual, Equal,
+                          NotEqual, Call, Get, Set, Grouping, Literal, Unary,
+                          Variable, ListLiteral, Index, SetIndex>;
 
 struct Assign {
   std::optional<size_t> id;
@@ -38,16 +58,37 @@ struct Logical {
       : left(left), op(op), right(right) {}
 };
 
+// Operand types a binary node has specialized its evaluation for. A node
+// starts UNEXECUTED, picks NUMBER or STRING from the operands it first sees
+// and drops to GENERIC for good when that guess is wrong (see quickening in
+// interpreter.cpp).
+enum class Specialization { UNEXECUTED, NUMBER, STRING, GENERIC };
+
+// Type of a value as far as static analysis can tell. Operator nodes record
+// the type proven for their operands so the interpreter can skip its runtime
+// operand checks (see TypeInference).
+enum class StaticType { UNKNOWN, NUMBER, STRING, BOOLEAN, NIL };
+
+// Fields shared by every BinaryOp, so passes that don't care about the
+// operator can take a Binary &.
 struct Binary {
   std::optional<size_t> id;
   std::shared_ptr<Expr> left;
   Token op;
   std::shared_ptr<Expr> right;
+  Specialization specialization = Specialization::UNEXECUTED;
+  StaticType operandType = StaticType::UNKNOWN;
+  size_t hits = 0;
+  size_t deopts = 0;
 
   Binary(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right)
       : left(left), op(op), right(right) {}
 };
 
+template <TokenType OP> struct BinaryOp : Binary {
+  using Binary::Binary;
+};
+
 struct Call {
   std::optional<size_t> id;
   std::shared_ptr<Expr> callee;
@@ -93,6 +134,7 @@ struct Unary {
   std::optional<size_t> id;
   Token op;
   std::shared_ptr<Expr> right;
+  StaticType operandType = StaticType::UNKNOWN;
 
   Unary(Token op, std::shared_ptr<Expr> right) : op(op), right(right) {}
 };
@@ -103,3 +145,42 @@ struct Variable {
 
   Variable(Token name) : name(name) {}
 };
+
+struct ListLiteral {
+  Token bracket;
+  std::vector<std::shared_ptr<Expr>> elements;
+
+  ListLiteral(Token bracket, std::vector<std::shared_ptr<Expr>> elements)
+      : bracket(bracket), elements(elements) {}
+};
+
+struct Index {
+  std::shared_ptr<Expr> object;
+  Token bracket;
+  std::shared_ptr<Expr> index;
+
+  Index(std::shared_ptr<Expr> object, Token bracket,
+        std::shared_ptr<Expr> index)
+      : object(object), bracket(bracket), index(index) {}
+};
+
+struct SetIndex {
+  std::shared_ptr<Expr> object;
+  Token bracket;
+  std::shared_ptr<Expr> index;
+  std::shared_ptr<Expr> value;
+
+  SetIndex(std::shared_ptr<Expr> object, Token bracket,
+           std::shared_ptr<Expr> index, std::shared_ptr<Expr> value)
+      : object(object), bracket(bracket), index(index), value(value) {}
+};
+
+// Visitor yielding the Binary base of an operator node, or nullptr for any
+// other node, so passes can handle every operator in one place.
+struct AsBinary {
+  template <TokenType OP> Binary *operator()(BinaryOp<OP> &expr) {
+    return &expr;
+  }
+
+  template <typename T> Binary *operator()(T &expr) { return nullptr; }
+};
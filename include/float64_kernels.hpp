@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+// Element-wise and reducing kernels over arrays of doubles. float64Kernels()
+// picks an AVX2 and FMA build when the processor has both, checked once at
+// run time, and a scalar build otherwise. Element-wise results are the same
+// either way; sums and dot products may round differently, since the
+// vector build adds in a different order.
+struct Float64Kernels {
+  void (*add)(const double *a, const double *b, double *out, size_t size);
+  void (*mul)(const double *a, const double *b, double *out, size_t size);
+  // a * b + c, rounded once.
+  void (*fma)(const double *a, const double *b, const double *c, double *out,
+              size_t size);
+  void (*scale)(const double *a, double factor, double *out, size_t size);
+  void (*sqrt)(const double *a, double *out, size_t size);
+  double (*sum)(const double *a, size_t size);
+  double (*dot)(const double *a, const double *b, size_t size);
+  // size must not be 0.
+  double (*min)(const double *a, size_t size);
+  double (*max)(const double *a, size_t size);
+};
+
+const Float64Kernels &float64Kernels();
+
+// The scalar build, whatever the processor supports.
+const Float64Kernels &scalarFloat64Kernels();
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "expr.hpp"
+#include "interpreter.hpp"
+#include "pass.hpp"
+#include "stmt.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Replaces calls to small functions with the function's body. A function
+// qualifies when its body is a single 'return expr;' where expr only uses
+// its parameters, literals, operators and property reads, within the size
+// threshold; such a body can't call anything, so it is never recursive.
+//
+// A call site is only rewritten when its callee is a variable bound
+// statically to the declaration: a local, or a global declared exactly once
+// outside the REPL, that is never assigned to. Arguments are substituted
+// for parameters, so they must be literals or variables unless evaluating
+// the body starts with the argument's only use, which keeps the order of
+// evaluation and any runtime error unchanged.
+class Inliner : public Pass {
+private:
+  struct CallSite {
+    std::shared_ptr<Expr> *slot;
+    Func *target;
+    bool global;
+  };
+
+  Interpreter &interpreter;
+  std::vector<std::unordered_map<std::string, Func *>> scopes{};
+  std::unordered_map<std::string, Func *> globals{};
+  std::unordered_map<std::string, size_t> globalDecls{};
+  std::unordered_set<std::string> assignedNames{};
+  std::shared_ptr<Expr> *currentSlot{nullptr};
+  std::vector<CallSite> callSites{};
+
+  std::unordered_set<Func *> inlinedFunctions{};
+  size_t inlinedCalls{0};
+
+  void declare(const std::string &name, Func *func);
+  Func *resolve(const Variable &callee, bool &global);
+
+  bool isParam(const Variable &variable) const;
+  size_t bodySize(const std::shared_ptr<Expr> &expr) const;
+  static size_t uses(const std::shared_ptr<Expr> &expr,
+                     const std::string &name);
+  static const Variable *firstLeaf(const std::shared_ptr<Expr> &expr);
+
+  bool inlineCall(const CallSite &site);
+  std::shared_ptr<Expr>
+  substitute(const std::shared_ptr<Expr> &expr,
+             std::unordered_map<std::string, std::shared_ptr<Expr>> &args);
+
+public:
+  Inliner(Interpreter &interpreter);
+
+  std::string name() const override;
+
+  void run(std::vector<std::shared_ptr<Stmt>> &statements) override;
+
+  void report(std::ostream &out) const override;
+
+  void operator()(Block &stmt);
+
+  void operator()(Class &stmt);
+
+  void operator()(Expression &stmt);
+
+  void operator()(Func &stmt);
+
+  void operator()(If &stmt);
+
+  void operator()(Print &stmt);
+
+  void operator()(Return &stmt);
+
+  void operator()(Var &stmt);
+
+  void operator()(While &stmt);
+
+  void operator()(Assign &expr);
+
+  void operator()(Logical &expr);
+
+  void operator()(Binary &expr);
+
+  void operator()(Call &expr);
+
+  void operator()(Get &expr);
+
+  void operator()(Set &expr);
+
+  void operator()(Grouping &expr);
+
+  void operator()(Literal &expr);
+
+  void operator()(Unary &expr);
+
+  void operator()(Variable &expr);
+
+  void operator()(ListLiteral &expr);
+
+  void operator()(Index &expr);
+
+  void operator()(SetIndex &expr);
+
+  void analyze(std::vector<std::shared_ptr<Stmt>> &statements);
+
+  void analyze(std::shared_ptr<Stmt> &statement);
+
+  void analyze(std::shared_ptr<Expr> &expr);
+};
@@ -4,9 +4,17 @@
 #include "expr.hpp"
 #include "stmt.hpp"
 #include "token.hpp"
+#include <mutex>
+#include <ostream>
 #include <unordered_map>
 #include <vector>
 
+class LoxCallable;
+
+// How a statement finished. RETURN leaves the function with returnValue;
+// TAIL_CALL leaves it to call tailCallee with tailArgs in its place.
+enum class Completion { NORMAL, RETURN, TAIL_CALL };
+
 struct Interpreter {
   Interpreter();
 
@@ -14,7 +22,7 @@ struct Interpreter {
 
   LiteralObject operator()(Unary &unary);
 
-  LiteralObject operator()(Binary &binary);
+  template <TokenType OP> LiteralObject operator()(BinaryOp<OP> &binary);
 
   LiteralObject operator()(Call &call);
 
@@ -30,36 +38,76 @@ struct Interpreter {
 
   LiteralObject operator()(Variable &variable);
 
-  void operator()(Block &stmt);
+  LiteralObject operator()(ListLiteral &list);
+
+  LiteralObject operator()(Index &index);
+
+  LiteralObject operator()(SetIndex &setIndex);
 
-  void operator()(Class &stmt);
+  Completion operator()(Block &stmt);
 
-  void operator()(Print &stmt);
+  Completion operator()(Class &stmt);
 
-  void operator()(If &stmt);
+  Completion operator()(Print &stmt);
 
-  void operator()(Expression &stmt);
+  Completion operator()(If &stmt);
 
-  void operator()(Func &stmt);
+  Completion operator()(Expression &stmt);
 
-  void operator()(Var &stmt);
+  Completion operator()(Func &stmt);
 
-  void operator()(Return &stmt);
+  Completion operator()(Var &stmt);
 
-  void operator()(While &stmt);
+  Completion operator()(Return &stmt);
+
+  Completion operator()(While &stmt);
 
   void interpret(std::vector<std::shared_ptr<Stmt>> &stmts);
 
   LiteralObject evaluate(Expr &expr);
 
-  void executeBlock(std::vector<std::shared_ptr<Stmt>> statements,
-                    std::shared_ptr<Environment> environment);
+  Completion execute(Stmt &stmt);
+
+  Completion executeBlock(const std::vector<std::shared_ptr<Stmt>> &statements,
+                          std::shared_ptr<Environment> environment);
+
+  std::shared_ptr<LoxCallable> evaluateCall(Call &call,
+                                            std::vector<LiteralObject> &args);
 
   void resolve(std::shared_ptr<Expr> expr, int hops, size_t id);
 
-  LiteralObject lookUpVariable(Token name, Variable &expr);
+  LiteralObject lookUpVariable(const Token &name, Variable &expr);
 
   std::shared_ptr<Environment> globals = std::make_shared<Environment>();
   std::shared_ptr<Environment> environment = globals;
   std::unordered_map<size_t, int> locals{};
+
+  // Guards resolve(), called by Resolvers on the module loader's threads.
+  std::mutex localsMutex{};
+
+  LiteralObject returnValue{};
+  std::shared_ptr<LoxCallable> tailCallee{};
+  std::vector<LiteralObject> tailArgs{};
+
+  // Applies a binary operator to arbitrary values, with the full operand
+  // checks. Also used by constant folding, so folded and evaluated
+  // expressions always agree.
+  template <TokenType OP>
+  static LiteralObject genericOp(const Token &op, const LiteralObject &left,
+                                 const LiteralObject &right);
+
+  // Binary nodes that have been quickened, kept only for --quicken-stats.
+  static std::vector<Binary *> quickenedNodes;
+
+  static void reportQuickening(std::ostream &out);
 };
+
+// Operand checks throwing the interpreter's runtime errors, shared with the
+// code compiled ahead of time (see AotRuntime).
+void checkNumberOperand(const Token &op, const LiteralObject &obj);
+
+size_t checkIndex(Token bracket, LiteralObject index, size_t size);
+
+void checkFloat64Element(Token bracket, LiteralObject value);
+
+void checkMapKey(Token bracket, LiteralObject key);
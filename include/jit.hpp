@@ -0,0 +1,101 @@
+#pragma once
+
+#include "interpreter.hpp"
+#include "stmt.hpp"
+#include "token.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Native code for one pure function, compiled once the function gets hot.
+// The code takes its arguments as doubles and returns a Jit::Result; the
+// result value, if any, is written through `result`.
+class JitFunction {
+public:
+  using Entry = int (*)(const double *args, double *result, int64_t *depth);
+
+  // A global the code calls through Jit::callOut.
+  struct Callee {
+    Token name;
+    size_t arity;
+  };
+
+  std::string name;
+  Interpreter *interpreter{nullptr};
+  std::vector<Callee> callees{};
+  Entry entry{nullptr};
+  void *code{nullptr};
+  size_t codeSize{0};
+  bool failed{false};
+  bool deoptimized{false};
+  size_t calls{0};
+  size_t nativeCalls{0};
+  size_t guardMisses{0};
+  size_t bailouts{0};
+
+  JitFunction(std::string name);
+  ~JitFunction();
+
+  JitFunction(const JitFunction &) = delete;
+  JitFunction &operator=(const JitFunction &) = delete;
+};
+
+// Template JIT for x86-64. Compiles the subset of Lox that works on numbers
+// and booleans only: literals, locals, arithmetic, comparisons, logical
+// operators, if, while, return, and calls to global functions, where calls
+// to the function itself are native and self tail calls are jumps. Each
+// expression's type is known statically, given that every argument is a
+// number; that is the one guard checked on entry. Anything the code cannot
+// finish (a callee failing or returning a non-number, too deep a
+// recursion) bails out, and since only pure functions are compiled the
+// tree-walker then simply runs the call again from the start.
+class Jit {
+public:
+  enum Result : int { BAILOUT, NUMBER, BOOLEAN, NIL };
+
+  enum class Outcome { RAN, NOT_RUN, BAILED_OUT };
+
+  // Calls before a function is compiled; with --jit=verify it is compiled on
+  // its first call.
+  static constexpr size_t HOT_THRESHOLD = 64;
+
+  static constexpr size_t MAX_ARGS = 8;
+
+  // Native frames deep the code goes before bailing out.
+  static constexpr int64_t MAX_DEPTH = 10000;
+
+  // Native frames a call through the interpreter counts as, its frames
+  // being that much bigger.
+  static constexpr int64_t CALL_OUT_DEPTH = 16;
+
+  // Nesting of tree-walker runs redoing a call that bailed out or checking
+  // a native result; calls made inside one stay in the tree-walker.
+  static size_t interpreting;
+
+  static bool compile(JitFunction &function, Func &func,
+                      Interpreter &interpreter);
+
+  // Runs the native code for a call, compiling it first if the function
+  // just got hot. NOT_RUN if it is not compiled or the guard fails.
+  static Outcome run(JitFunction &function, Func &func,
+                     Interpreter &interpreter,
+                     const std::vector<LiteralObject> &args,
+                     LiteralObject &result);
+
+  // Whether native code is running further up the stack.
+  static bool nested();
+
+  // Aborts, naming the call, when the native result is not the
+  // tree-walker's. NaNs compare equal to each other.
+  static void verify(const JitFunction &function,
+                     const std::vector<LiteralObject> &args,
+                     const LiteralObject &native, const LiteralObject &walked);
+
+  // Called from native code to call callees[index] with arity doubles.
+  static int callOut(JitFunction *caller, uint32_t index, const double *args,
+                     double *result);
+
+private:
+  static int64_t depth;
+};
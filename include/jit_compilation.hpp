@@ -0,0 +1,31 @@
+#pragma once
+
+#include "interpreter.hpp"
+#include "jit.hpp"
+#include "pass.hpp"
+#include "stmt.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Marks the pure top-level functions (see PurityAnalysis) for the JIT. Each
+// is compiled to native code the first time it gets hot, if all of its body
+// is in the subset Jit handles; until then, and for every call whose
+// arguments are not all numbers, it runs in the tree-walker. Opt-in with
+// -fjit or --jit=on; nothing is compiled in the REPL.
+class JitCompilation : public Pass {
+private:
+  Interpreter &interpreter;
+  size_t functions{0};
+  std::vector<std::shared_ptr<JitFunction>> candidates{};
+
+public:
+  JitCompilation(Interpreter &interpreter);
+
+  std::string name() const override;
+
+  void run(std::vector<std::shared_ptr<Stmt>> &statements) override;
+
+  void report(std::ostream &out) const override;
+};
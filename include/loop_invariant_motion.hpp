@@ -0,0 +1,125 @@
+#pragma once
+
+#include "expr.hpp"
+#include "interpreter.hpp"
+#include "pass.hpp"
+#include "stmt.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Loop-invariant code motion. Hoists operator expressions whose variables
+// the loop never changes into temporaries declared in a block wrapped
+// around the loop, then resolves the program again for the new scopes.
+// Expressions type inference proved can't fail are computed before the
+// loop; the rest are computed on first use and reused after that.
+//
+// Only locals are considered invariant: a global could be changed by any
+// call in the loop, and so could a local that some closure assigns to.
+// Expressions inside function declarations are left alone, since the
+// function may run after the loop has moved on.
+class LoopInvariantMotion : public Pass {
+private:
+  struct Loop {
+    std::shared_ptr<Stmt> *slot;
+    size_t firstDecl;
+    size_t endDecl;
+    std::unordered_set<size_t> assigned;
+  };
+
+  Interpreter &interpreter;
+
+  // Analysis state: every local declaration gets a number, and each
+  // resolved Variable and Assign node is mapped to the one it refers to.
+  std::vector<std::unordered_map<std::string, size_t>> scopes{};
+  std::vector<size_t> scopeDepths{};
+  std::vector<size_t> declDepths{};
+  size_t functionDepth{0};
+  std::unordered_map<size_t, size_t> declOf{};
+  std::unordered_set<size_t> capturedWrites{};
+  std::shared_ptr<Stmt> *currentSlot{nullptr};
+  std::vector<Loop> openLoops{};
+  std::vector<Loop> loops{};
+
+  size_t temporaries{0};
+  size_t hoistedExprs{0};
+  size_t changedLoops{0};
+
+  void declare(const std::string &name);
+  std::optional<size_t> resolve(const std::optional<size_t> &id,
+                                const std::string &name);
+
+  static bool isTrivial(const std::shared_ptr<Expr> &expr);
+  static bool isArithmetic(const std::shared_ptr<Expr> &expr);
+  static bool cannotFail(const std::shared_ptr<Expr> &expr);
+  Token temporary();
+
+  bool isVariant(const Loop &loop, size_t decl) const;
+  bool isInvariant(const Loop &loop, const std::shared_ptr<Expr> &expr);
+  void hoist(Loop &loop, std::shared_ptr<Expr> &expr,
+             std::vector<std::shared_ptr<Stmt>> &hoisted);
+  void hoist(Loop &loop, std::shared_ptr<Stmt> &stmt,
+             std::vector<std::shared_ptr<Stmt>> &hoisted);
+
+public:
+  LoopInvariantMotion(Interpreter &interpreter);
+
+  std::string name() const override;
+
+  void run(std::vector<std::shared_ptr<Stmt>> &statements) override;
+
+  void report(std::ostream &out) const override;
+
+  void operator()(Block &stmt);
+
+  void operator()(Class &stmt);
+
+  void operator()(Expression &stmt);
+
+  void operator()(Func &stmt);
+
+  void operator()(If &stmt);
+
+  void operator()(Print &stmt);
+
+  void operator()(Return &stmt);
+
+  void operator()(Var &stmt);
+
+  void operator()(While &stmt);
+
+  void operator()(Assign &expr);
+
+  void operator()(Logical &expr);
+
+  void operator()(Binary &expr);
+
+  void operator()(Call &expr);
+
+  void operator()(Get &expr);
+
+  void operator()(Set &expr);
+
+  void operator()(Grouping &expr);
+
+  void operator()(Literal &expr);
+
+  void operator()(Unary &expr);
+
+  void operator()(Variable &expr);
+
+  void operator()(ListLiteral &expr);
+
+  void operator()(Index &expr);
+
+  void operator()(SetIndex &expr);
+
+  void analyze(std::vector<std::shared_ptr<Stmt>> &statements);
+
+  void analyze(std::shared_ptr<Stmt> &statement);
+
+  void analyze(std::shared_ptr<Expr> &expr);
+};
@@ -8,7 +8,7 @@
 class LoxCallable {
 public:
   virtual int arity() = 0;
-  virtual LiteralObject call(Interpreter interpreter,
+  virtual LiteralObject call(Interpreter &interpreter,
                              std::vector<LiteralObject> args) = 0;
   virtual std::string toString() const = 0;
 };
@@ -16,7 +16,7 @@ public:
 class ClockFunc : public LoxCallable {
 public:
   int arity() override;
-  LiteralObject call(Interpreter interpreter,
+  LiteralObject call(Interpreter &interpreter,
                      std::vector<LiteralObject> args) override;
   std::string toString() const override;
 };
@@ -26,12 +26,16 @@ private:
   std::shared_ptr<Func> funcDeclaration;
   std::shared_ptr<Environment> closure;
 
+  LiteralObject invoke(Interpreter &interpreter,
+                       std::vector<LiteralObject> args);
+  LiteralObject walk(Interpreter &interpreter, std::vector<LiteralObject> args);
+
 public:
   LoxFunc(std::shared_ptr<Func> funcDeclaration,
           std::shared_ptr<Environment> closure);
 
   int arity() override;
-  LiteralObject call(Interpreter interpreter,
+  LiteralObject call(Interpreter &interpreter,
                      std::vector<LiteralObject> args) override;
   std::string toString() const override;
 };
@@ -43,7 +47,7 @@ public:
   LoxClass(std::string name);
 
   int arity() override;
-  LiteralObject call(Interpreter interpreter,
+  LiteralObject call(Interpreter &interpreter,
                      std::vector<LiteralObject> args) override;
   std::string toString() const override;
 };
@@ -54,10 +58,11 @@ public:
   std::unordered_map<std::string, LiteralObject> fields{};
 
   LoxInstance(LoxClass *name);
+  ~LoxInstance();
 
   std::string toString() const;
 
-  LiteralObject get(Token name);
+  LiteralObject get(const Token &name);
 
-  void set(Token name, LiteralObject value);
+  void set(const Token &name, LiteralObject value);
 };
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "lox_callable.hpp"
+#include "token.hpp"
+#include <string>
+#include <vector>
+
+// CSV over a reader, following RFC 4180: fields are separated by commas,
+// records by "\n" or "\r\n", and a field in double quotes may hold commas,
+// newlines and doubled quotes. Unquoted fields that are numbers come back
+// as numbers, parsed straight from the reader's buffer; everything else is
+// a string. Blank lines are skipped.
+
+// csvRow(reader) returns the next record as a list, or nil at the end.
+class CsvRowFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+// csvEach(reader, fn) calls fn with each remaining record and returns how
+// many there were.
+class CsvEachFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
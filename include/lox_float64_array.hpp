@@ -0,0 +1,125 @@
+#pragma once
+
+#include "lox_callable.hpp"
+#include "native_object.hpp"
+#include "token.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A fixed-size array of doubles in one contiguous block, aligned to a cache
+// line, indexed with array[i] like a list. The bulk natives run over it with
+// float64Kernels() instead of one Lox operation per element.
+class LoxFloat64Array : public NativeObject {
+public:
+  static constexpr size_t ALIGNMENT = 64;
+
+  // The most elements whose size in bytes, rounded up to the alignment,
+  // still fits in a size_t.
+  static constexpr size_t MAX_SIZE = (SIZE_MAX - ALIGNMENT) / sizeof(double);
+
+  double *data;
+  const size_t size;
+
+  // Throws a NativeError if size is over MAX_SIZE or the memory can't be
+  // allocated.
+  LoxFloat64Array(size_t size);
+  ~LoxFloat64Array() override;
+
+  LoxFloat64Array(const LoxFloat64Array &) = delete;
+  LoxFloat64Array &operator=(const LoxFloat64Array &) = delete;
+
+  std::string toString() const override;
+};
+
+// The array obj holds, or null if it holds something else.
+std::shared_ptr<LoxFloat64Array> asFloat64Array(const LiteralObject &obj);
+
+// Float64Array(size) is zero-filled; Float64Array(list) copies a list of
+// numbers.
+class Float64ArrayFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+// add(a, b), mul(a, b) and fma(a, b, c) (a * b + c) work element by element
+// on arrays of the same size, scale(a, factor) multiplies every element,
+// and each returns a new array.
+class AddFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class MulFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class FmaFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class ScaleFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+// sqrt(x) takes a number or an array.
+class SqrtFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class SumFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class DotFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+// min(a) and max(a) are nil for an empty array.
+class MinFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class MaxFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
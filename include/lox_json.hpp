@@ -0,0 +1,25 @@
+#pragma once
+
+#include "lox_callable.hpp"
+#include "token.hpp"
+#include <string>
+#include <vector>
+
+// jsonParse(string) builds maps, lists, strings, numbers, booleans and nil
+// from a JSON document. jsonStringify(value) goes the other way; instances
+// are written as objects of their fields.
+class JsonParseFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class JsonStringifyFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "lox_callable.hpp"
+#include "token.hpp"
+#include <string>
+#include <vector>
+
+class LoxList {
+public:
+  std::vector<LiteralObject> elements{};
+
+  LoxList() = default;
+  LoxList(std::vector<LiteralObject> elements);
+
+  std::string toString() const;
+};
+
+class LenFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class PushFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class PopFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "lox_callable.hpp"
+#include "token.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Open-addressing hash map with linear probing. Each slot caches the key's
+// hash so probes only compare keys on a hash match. Growing the table is
+// incremental: a new table is allocated and a few slots of the old one are
+// moved across on every insert or remove, so no single write pays for a
+// full rehash.
+class LoxMap {
+private:
+  static constexpr uint64_t EMPTY = 0;
+  static constexpr uint64_t TOMBSTONE = 1;
+  static constexpr size_t MIGRATE_STEP = 16;
+
+  struct Slot {
+    uint64_t hash = EMPTY;
+    LiteralObject key{};
+    LiteralObject value{};
+  };
+
+  std::vector<Slot> slots{};
+  std::vector<Slot> oldSlots{};
+  size_t migrated{0};
+  size_t count{0};
+  size_t oldCount{0};
+  size_t tombstones{0};
+
+  Slot *findIn(std::vector<Slot> &table, const LiteralObject &key,
+               uint64_t hash);
+  void insertNew(uint64_t hash, LiteralObject key, LiteralObject value);
+  void grow();
+  void migrate(size_t steps);
+
+public:
+  static bool isValidKey(const LiteralObject &key);
+  static uint64_t hashKey(const LiteralObject &key);
+  static bool keysEqual(const LiteralObject &a, const LiteralObject &b);
+
+  // Sizes an empty map for n entries, so filling it never resizes.
+  void reserve(size_t n);
+
+  LiteralObject *find(const LiteralObject &key);
+  void set(LiteralObject key, LiteralObject value);
+  bool remove(const LiteralObject &key);
+  size_t size() const;
+  size_t capacity() const;
+
+  std::vector<LiteralObject> keys() const;
+  std::vector<LiteralObject> values() const;
+  std::string toString() const;
+};
+
+class MapFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class HasFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class RemoveFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class KeysFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class ValuesFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
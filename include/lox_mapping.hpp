@@ -0,0 +1,94 @@
+#pragma once
+
+#include "lox_callable.hpp"
+#include "native_object.hpp"
+#include "token.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A file mapped read-only into memory, unmapped once no view refers to it.
+class LoxMapping {
+public:
+  std::string path;
+  const char *data{nullptr};
+  size_t size{0};
+
+  LoxMapping(std::string path, const char *data, size_t size);
+  ~LoxMapping();
+
+  LoxMapping(const LoxMapping &) = delete;
+  LoxMapping &operator=(const LoxMapping &) = delete;
+
+  // Nullptr if the file can't be opened or mapped.
+  static std::shared_ptr<LoxMapping> map(const std::string &path);
+};
+
+// A range of bytes of a mapping. Slicing makes another view of the same
+// mapping and searching works on the mapped pages, so nothing is copied
+// until text() asks for a string.
+class LoxView : public NativeObject {
+public:
+  std::shared_ptr<LoxMapping> mapping;
+  size_t offset;
+  size_t length;
+
+  LoxView(std::shared_ptr<LoxMapping> mapping, size_t offset, size_t length);
+
+  std::string_view bytes() const;
+
+  std::string toString() const override;
+};
+
+std::shared_ptr<LoxView> checkView(const LiteralObject &obj,
+                                   std::string fnName);
+
+class MmapFileFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class SliceFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class FindFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class ByteAtFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class TextFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class AdviseFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "lox_callable.hpp"
+#include "native_object.hpp"
+#include "token.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A file or stdin read through one reusable buffer, so input of any size
+// streams through bounded memory: readLine and readChunk only copy out what
+// they return. The buffer only grows to hold a line, or a chunk, longer
+// than itself.
+class LoxReader : public NativeObject {
+private:
+  static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+  std::string name;
+  std::FILE *file;
+  bool owned;
+  std::vector<char> buffer;
+  size_t start{0};
+  size_t end{0};
+  bool atEnd{false};
+
+  bool fill();
+  void checkOpen() const;
+
+public:
+  LoxReader(std::string name, std::FILE *file, bool owned);
+  ~LoxReader() override;
+
+  // The next line without its "\n" or "\r\n", or nil once the input is
+  // used up. A last line without a newline is still returned.
+  LiteralObject readLine();
+
+  // The next size bytes, fewer at the end of the input, or nil after it.
+  LiteralObject readChunk(size_t size);
+
+  // The next CSV record, RFC 4180 style: everything up to a newline that
+  // is not inside double quotes, without the newline. Points into the
+  // buffer, so it is only valid until the next read. Its data() is null
+  // once the input is used up.
+  std::string_view readRecord();
+
+  void close();
+
+  std::string toString() const override;
+};
+
+std::shared_ptr<LoxReader> checkReader(const LiteralObject &obj,
+                                       std::string fnName);
+
+class OpenFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+// Always returns the same reader, since two buffers can't share stdin.
+class StdinFunc : public LoxCallable {
+private:
+  std::shared_ptr<LoxReader> reader{};
+
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class ReadLineFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class ReadChunkFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
+
+class CloseFunc : public LoxCallable {
+public:
+  int arity() override;
+  LiteralObject call(Interpreter &interpreter,
+                     std::vector<LiteralObject> args) override;
+  std::string toString() const override;
+};
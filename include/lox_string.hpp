@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Immutable Lox string, shared by pointer between every value that holds it
+// so copying a string value is a refcount bump. Concatenation builds a rope
+// node that points at both operands instead of copying them, so
+// `s = s + piece` costs O(len(piece)). The rope is flattened into a single
+// buffer the first time its characters are needed (printing, comparing,
+// hashing) and its children are released.
+//
+// A substring is a slice: it points into the characters of the string it
+// was taken from rather than copying them, until something needs it as a
+// std::string of its own.
+class LoxString {
+private:
+  // Concatenations and substrings shorter than this are copied eagerly; a
+  // rope node or slice is not worth it for small strings.
+  static constexpr size_t ROPE_THRESHOLD = 64;
+
+  mutable std::string chars;
+  mutable std::shared_ptr<LoxString> left;
+  mutable std::shared_ptr<LoxString> right;
+  mutable std::shared_ptr<LoxString> base;
+  size_t offset{0};
+  size_t length;
+  mutable size_t hashCode{0};
+  mutable bool hashed{false};
+
+  void flatten() const;
+
+public:
+  LoxString(std::string chars);
+  LoxString(std::shared_ptr<LoxString> left, std::shared_ptr<LoxString> right);
+  ~LoxString();
+
+  static std::shared_ptr<LoxString>
+  concat(const std::shared_ptr<LoxString> &left,
+         const std::shared_ptr<LoxString> &right);
+
+  // The length characters of string from offset, which must be in range.
+  static std::shared_ptr<LoxString>
+  substr(const std::shared_ptr<LoxString> &string, size_t offset,
+         size_t length);
+
+  size_t size() const;
+
+  // Computed on first use and cached, since strings never change.
+  size_t hash() const;
+
+  const std::string &str() const;
+
+  // The characters without copying a slice out of its base.
+  std::string_view view() const;
+
+  bool operator==(const LoxString &other) const;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "token.hpp"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Results of a pure function keyed on its arguments. Only calls whose
+// arguments are all numbers, strings, booleans or nil are cached; numbers
+// compare by bit pattern so that 0 and -0 stay distinct keys. The cache
+// holds at most `capacity` entries and is emptied when it fills up, which
+// keeps it bounded without per-entry bookkeeping.
+class MemoCache {
+private:
+  struct KeyHash {
+    size_t operator()(const std::vector<LiteralObject> &key) const;
+  };
+
+  struct KeyEqual {
+    bool operator()(const std::vector<LiteralObject> &a,
+                    const std::vector<LiteralObject> &b) const;
+  };
+
+  std::unordered_map<std::vector<LiteralObject>, LiteralObject, KeyHash,
+                     KeyEqual>
+      entries{};
+  size_t capacity;
+  size_t stringBytes{0};
+
+  static size_t stringSize(const LiteralObject &value);
+
+public:
+  std::string name;
+  size_t hits{0};
+  size_t misses{0};
+  size_t flushes{0};
+
+  MemoCache(std::string name, size_t capacity);
+
+  static bool isKey(const std::vector<LiteralObject> &args);
+
+  const LiteralObject *find(const std::vector<LiteralObject> &args);
+
+  void insert(std::vector<LiteralObject> args, LiteralObject value);
+
+  size_t size() const;
+
+  // Approximate heap footprint of the entries, their keys and the strings
+  // they hold.
+  size_t memoryBytes() const;
+};
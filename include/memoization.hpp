@@ -0,0 +1,30 @@
+#pragma once
+
+#include "interpreter.hpp"
+#include "memo_cache.hpp"
+#include "pass.hpp"
+#include "stmt.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Gives each pure top-level function (see PurityAnalysis) a memo cache, so
+// repeated calls with the same arguments return the cached result. Opt-in
+// with -fmemoize. Nothing is memoized in the REPL, where a later line can
+// redefine any global.
+class Memoization : public Pass {
+private:
+  Interpreter &interpreter;
+  size_t functions{0};
+  std::vector<std::shared_ptr<MemoCache>> caches{};
+
+public:
+  Memoization(Interpreter &interpreter);
+
+  std::string name() const override;
+
+  void run(std::vector<std::shared_ptr<Stmt>> &statements) override;
+
+  void report(std::ostream &out) const override;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runtime counters, served in the Prometheus text format by
+// --metrics=<port|path> while a script runs.
+//
+// Each thread counts into a block of its own, so counting is a plain load
+// and store that no other thread writes; they are relaxed atomics only so
+// that a scrape reading them from the endpoint's thread is well defined.
+// A scrape adds up the blocks of all threads, and of those that have
+// exited. Heap usage is not counted at all but asked of malloc per scrape.
+class Metrics {
+public:
+  enum Counter {
+    CALLS,
+    ENVIRONMENTS,
+    INSTANCES,
+    LIVE_INSTANCES,
+    FIELD_WRITES,
+    STATEMENTS,
+    RUNTIME_ERRORS,
+    COUNTERS
+  };
+
+  static void add(Counter counter, int64_t amount = 1) {
+    Block *block = local != nullptr ? local : attach();
+    std::atomic<int64_t> &value = block->values[counter];
+    value.store(value.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+  }
+
+  // The current values in the Prometheus text exposition format.
+  static std::string render();
+
+  // Serves render() over HTTP from a background thread: on 127.0.0.1 if
+  // address is a port number, otherwise on a Unix socket at that path.
+  // Returns false, after saying why, if it can't listen there.
+  static bool listen(const std::string &address);
+
+  // Stops the endpoint, if one is running, and removes its socket file.
+  static void stop();
+
+private:
+  struct Block {
+    std::atomic<int64_t> values[COUNTERS];
+  };
+
+  // Folds a thread's block into the retired totals when the thread exits.
+  struct Detach {
+    ~Detach();
+  };
+
+  // Every live thread's block and the totals of exited threads, guarded
+  // by mutex. Counting starts during static initialization (the global
+  // environment), so this is built on first use and never destroyed.
+  struct Registry {
+    std::mutex mutex{};
+    std::vector<Block *> blocks{};
+    int64_t retired[COUNTERS]{};
+  };
+
+  inline static thread_local Block *local = nullptr;
+
+  static Registry &registry();
+
+  static std::thread server;
+  static int listener;
+  static std::string socketPath;
+
+  static Block *attach();
+  static void run();
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "interpreter.hpp"
+#include "stmt.hpp"
+#include "thread_pool.hpp"
+#include "token.hpp"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Loads the modules named by `import "path";` declarations. Paths are
+// relative to the importing file. Imports are hoisted: every module runs
+// once, before the code importing it, and a module's own imports run before
+// it, in declaration order. A cycle just stops at the module already being
+// linked.
+//
+// Modules are scanned, parsed and resolved on a thread pool, each one as
+// soon as the import naming it has been parsed, so independent modules are
+// compiled in parallel. Compiled modules are cached by their source text
+// for the life of the process: a module is compiled and run once however
+// many scripts (or REPL lines) import it, and under whatever path. A file
+// that changed is a new module.
+class ModuleLoader {
+private:
+  struct Module {
+    std::vector<std::shared_ptr<Stmt>> statements{};
+    std::vector<Token> imports{};
+    bool ran{false};
+  };
+
+  Interpreter &interpreter;
+  std::unique_ptr<ThreadPool> pool{};
+
+  // Guards everything below while the pool is compiling.
+  std::mutex mutex{};
+  std::unordered_map<std::string, std::shared_ptr<Module>> cache{};
+  size_t compilations{0};
+  size_t cacheHits{0};
+
+  // The modules of the current load() by path, and the paths requested.
+  std::unordered_map<std::string, std::shared_ptr<Module>> loaded{};
+  std::unordered_set<std::string> requested{};
+
+  static std::string locate(const std::string &directory, const Token &path);
+  static std::string canonical(const std::string &path);
+  static std::string directoryOf(const std::string &path);
+
+  void request(const std::string &path, const Token &import);
+  void compile(const std::string &path, const Token &import);
+  void link(const std::string &path, std::unordered_set<Module *> &visited,
+            std::vector<std::shared_ptr<Stmt>> &program);
+
+public:
+  ModuleLoader(Interpreter &interpreter);
+
+  // Compiles the modules imported from a script in directory, and the
+  // modules they import, and returns the statements of those that have not
+  // run yet, in the order to run them. Reports errors through
+  // errorReporter, in which case nothing is returned. script is the path
+  // of the importing file, empty at the prompt; a module importing it back
+  // closes a cycle there instead of running the script again.
+  std::vector<std::shared_ptr<Stmt>> load(const std::vector<Token> &imports,
+                                          const std::string &directory,
+                                          const std::string &script);
+
+  void report(std::ostream &out);
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+// Base of values implemented in C++ that scripts only handle through
+// natives, such as file readers. They are always truthy and compare by
+// identity.
+class NativeObject {
+public:
+  virtual ~NativeObject() = default;
+
+  virtual std::string toString() const = 0;
+};
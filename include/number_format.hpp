@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+// Room formatNumber needs: 25 characters for the longest number it writes,
+// such as "-0.0000012345678901234567".
+constexpr size_t NUMBER_BUFFER_SIZE = 32;
+
+// Writes the shortest text that reads back as exactly value into buffer
+// and returns its end, without allocating. As in JavaScript, magnitudes
+// from 1e-6 up to 1e21 are written out ("3", "0.1", "0.000001") and the
+// rest in exponent form ("1e+21", "1e-7"). NaN is "nan", infinities "inf"
+// and "-inf".
+char *formatNumber(double value, char *buffer);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "output.hpp"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+// Command line switches, set once in main() before anything runs.
+struct Options {
+  // Print each quickened Binary node's specialization and counters.
+  bool quickenStats{false};
+
+  // Print analysis and optimization statistics to stderr after each run.
+  bool stats{false};
+
+  // Optimization level picking the default set of passes (-O0 to -O2).
+  int optLevel{1};
+
+  // Per-pass overrides of optLevel, from -f<pass> and -fno-<pass>.
+  std::unordered_map<std::string, bool> passToggles{};
+
+  // Largest function body, in AST nodes, the inliner will substitute.
+  size_t inlineThreshold{16};
+
+  // Most entries each memoized function's cache holds before it is emptied.
+  size_t memoCacheSize{1024};
+
+  // Run the tree-walker alongside every native call and abort on a
+  // different result (--jit=verify).
+  bool jitVerify{false};
+
+  // Write the program as C++ to outputFile (or stdout) instead of running
+  // it (--emit-cpp, -o).
+  bool emitCpp{false};
+  std::string outputFile{};
+
+  // When print output is flushed (--flush=line|size|exit), the buffer size
+  // that flushes it under the size policy (--output-buffer=<bytes>), and
+  // whether a background thread writes it (--output-thread).
+  Output::Policy flushPolicy{Output::Policy::AUTO};
+  size_t outputBuffer{Output::DEFAULT_THRESHOLD};
+  bool outputThread{false};
+
+  // Where to serve runtime metrics while running (--metrics=<port|path>),
+  // or empty for nowhere.
+  std::string metricsAddress{};
+
+  // Reading from the prompt, where a later line may redefine any global.
+  bool interactive{false};
+};
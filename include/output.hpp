@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Where print goes. Output collects text in a buffer and writes it to stdout
+// in large chunks, instead of flushing on every line. When the buffer goes
+// out depends on the policy:
+//
+// - LINE: after every print, the default when stdout is a terminal.
+// - SIZE: once the buffer holds threshold bytes, the default otherwise.
+// - EXIT: only on exit, or when something else needs stdout.
+//
+// With a writer thread the chunks are written in the background while the
+// script keeps running. Anything else writing to stdout (error messages,
+// the REPL prompt) calls flush() first so the output stays in order.
+class Output {
+public:
+  enum class Policy { AUTO, LINE, SIZE, EXIT };
+
+  static constexpr size_t DEFAULT_THRESHOLD = 64 * 1024;
+
+  Output();
+  ~Output();
+
+  Output(const Output &) = delete;
+  Output &operator=(const Output &) = delete;
+
+  // AUTO picks LINE or SIZE depending on whether stdout is a terminal.
+  void configure(Policy policy, size_t threshold, bool writerThread);
+
+  // Appends a line.
+  void print(const std::string &text);
+
+  // Writes out everything printed so far and waits until it is written.
+  void flush();
+
+private:
+  Policy policy;
+  size_t threshold{DEFAULT_THRESHOLD};
+  std::string buffer{};
+
+  // Writer thread state, guarded by mutex: pending is handed over by
+  // submit() and written by run().
+  std::thread writer{};
+  std::mutex mutex{};
+  std::condition_variable ready{};
+  std::condition_variable drained{};
+  std::string pending{};
+  bool writing{false};
+  bool stopping{false};
+
+  void submit();
+  void run();
+  void stopWriter();
+
+  static void write(const std::string &chars);
+};
@@ -33,6 +33,8 @@ private:
   std::unique_ptr<Expr> primary();
   std::unique_ptr<Expr> call();
   std::unique_ptr<Expr> finishCall(std::shared_ptr<Expr> callee);
+  std::unique_ptr<Expr> makeBinary(std::unique_ptr<Expr> left, Token op,
+                                   std::unique_ptr<Expr> right);
 
   std::unique_ptr<Stmt> function(std::string kind);
   std::unique_ptr<Stmt> block();
@@ -46,12 +48,17 @@ private:
   std::unique_ptr<Stmt> whileStatement();
   std::unique_ptr<Stmt> forStatement();
   std::unique_ptr<Stmt> returnStatement();
+  void importDeclaration();
 
   std::shared_ptr<Token> consume(TokenType type, std::string message);
   ParseError error(Token token, std::string message);
   void synchronize();
 
 public:
+  // The path strings of the top-level import declarations, in order. They
+  // leave no statement behind: ModuleLoader runs the modules first.
+  std::vector<Token> imports{};
+
   Parser(std::vector<std::shared_ptr<Token>> tokens);
   std::vector<std::shared_ptr<Stmt>> parse();
 };
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "stmt.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A program transformation or analysis run by the PassManager between
+// resolution and interpretation.
+class Pass {
+public:
+  virtual ~Pass() = default;
+
+  virtual std::string name() const = 0;
+
+  virtual void run(std::vector<std::shared_ptr<Stmt>> &statements) = 0;
+
+  // Pass-specific statistics, printed under --stats.
+  virtual void report(std::ostream &out) const {}
+};
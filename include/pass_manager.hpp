@@ -0,0 +1,56 @@
+#pragma once
+
+#include "interpreter.hpp"
+#include "pass.hpp"
+#include "stmt.hpp"
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Runs the optimization pipeline between resolution and interpretation.
+// Which passes run is decided by the optimization level (-O0, -O1, -O2),
+// with -f<pass> and -fno-<pass> overriding it per pass; some passes only
+// run when asked for with -f<pass>. Each pass is timed; with --stats the
+// program's node count is also recorded before and after it, and in debug
+// builds the program is verified after every pass.
+class PassManager {
+private:
+  struct Registration {
+    std::string name;
+    int level;
+    std::function<std::shared_ptr<Pass>(Interpreter &)> create;
+  };
+
+  struct Record {
+    std::string name;
+    double millis;
+    size_t nodesBefore;
+    size_t nodesAfter;
+  };
+
+  static const std::vector<Registration> registry;
+
+  // Level of passes no -O level turns on; they only run with -f<pass>.
+  static constexpr int OPT_IN = 3;
+
+  std::vector<std::shared_ptr<Pass>> passes{};
+  std::vector<Record> records{};
+
+  static size_t countNodes(std::vector<std::shared_ptr<Stmt>> &statements,
+                           const std::string &after);
+
+public:
+  PassManager(Interpreter &interpreter, int level,
+              const std::unordered_map<std::string, bool> &toggles);
+
+  static bool isPass(const std::string &name);
+
+  static std::vector<std::string> passNames();
+
+  void run(std::vector<std::shared_ptr<Stmt>> &statements);
+
+  void report(std::ostream &out) const;
+};
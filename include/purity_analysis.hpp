@@ -0,0 +1,100 @@
+#pragma once
+
+#include "expr.hpp"
+#include "interpreter.hpp"
+#include "stmt.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Finds the pure top-level functions: those that only assign their own
+// locals, never print, set a field or an element, read a field or an
+// element, build a list or declare a function or class, and whose every
+// global read is of a constant, a pure function or the len native.
+// Constants and functions are globals declared once and never assigned;
+// constants must be initialized with a literal. Purity of callees is
+// settled by iterating to a fixpoint, so mutually recursive functions can
+// be pure together.
+//
+// Repeating a call to a pure function with the same arguments gives the
+// same result and has no effects the program can see.
+class PurityAnalysis {
+private:
+  struct Function {
+    Func *func;
+    bool pure;
+    std::unordered_set<std::string> reads;
+  };
+
+  Interpreter &interpreter;
+  Function *current{nullptr};
+  std::vector<Function> functions{};
+  std::unordered_map<std::string, size_t> globalDecls{};
+  std::unordered_set<std::string> globalAssigns{};
+  std::unordered_set<std::string> constants{};
+
+  bool isGlobal(const std::optional<size_t> &id) const;
+  void impure();
+  bool isPureRead(const std::string &name,
+                  const std::unordered_set<std::string> &pure) const;
+
+public:
+  size_t topLevelFunctions{0};
+  std::vector<Func *> pureFunctions{};
+
+  PurityAnalysis(Interpreter &interpreter);
+
+  void run(std::vector<std::shared_ptr<Stmt>> &statements);
+
+  void operator()(Block &stmt);
+
+  void operator()(Class &stmt);
+
+  void operator()(Expression &stmt);
+
+  void operator()(Func &stmt);
+
+  void operator()(If &stmt);
+
+  void operator()(Print &stmt);
+
+  void operator()(Return &stmt);
+
+  void operator()(Var &stmt);
+
+  void operator()(While &stmt);
+
+  void operator()(Assign &expr);
+
+  void operator()(Logical &expr);
+
+  void operator()(Binary &expr);
+
+  void operator()(Call &expr);
+
+  void operator()(Get &expr);
+
+  void operator()(Set &expr);
+
+  void operator()(Grouping &expr);
+
+  void operator()(Literal &expr);
+
+  void operator()(Unary &expr);
+
+  void operator()(Variable &expr);
+
+  void operator()(ListLiteral &expr);
+
+  void operator()(Index &expr);
+
+  void operator()(SetIndex &expr);
+
+  void analyze(std::vector<std::shared_ptr<Stmt>> &statements);
+
+  void analyze(std::shared_ptr<Stmt> &statement);
+
+  void analyze(std::shared_ptr<Expr> &expr);
+};
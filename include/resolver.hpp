@@ -3,6 +3,7 @@
 #include "expr.hpp"
 #include "interpreter.hpp"
 #include "stmt.hpp"
+#include <atomic>
 #include <string>
 #include <unordered_map>
 
@@ -15,7 +16,8 @@ private:
   FunctionType currentFunction = NONE;
 
 public:
-  static size_t counter;
+  // Atomic since modules are resolved on several threads at once.
+  static std::atomic<size_t> counter;
 
   Resolver(Interpreter &interpreter);
 
@@ -57,6 +59,12 @@ public:
 
   void operator()(Set &expr);
 
+  void operator()(ListLiteral &expr);
+
+  void operator()(Index &expr);
+
+  void operator()(SetIndex &expr);
+
   void declare(Token name);
 
   void define(Token name);
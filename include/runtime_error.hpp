@@ -13,3 +13,12 @@ public:
 
   RuntimeError(Token token, std::string message);
 };
+
+// Thrown by native functions, which have no token of their own. The
+// interpreter rethrows it as a RuntimeError at the call site's paren.
+class NativeError : public std::runtime_error {
+public:
+  std::string message;
+
+  NativeError(std::string message);
+};
@@ -15,7 +15,8 @@ private:
       {"and", TokenType::AND},       {"class", TokenType::CLASS},
       {"else", TokenType::ELSE},     {"false", TokenType::FALSE},
       {"for", TokenType::FOR},       {"fun", TokenType::FUN},
-      {"if", TokenType::IF},         {"nil", TokenType::NIL},
+      {"if", TokenType::IF},         {"import", TokenType::IMPORT},
+      {"nil", TokenType::NIL},
       {"or", TokenType::OR},         {"print", TokenType::PRINT},
       {"return", TokenType::RETURN}, {"super", TokenType::SUPER},
       {"this", TokenType::THIS},     {"true", TokenType::TRUE},
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Runs scripts for clients on the same machine over a Unix socket, so a
+// short job skips process startup and interpreter construction.
+//
+// A client sends its working directory and command line arguments, along
+// with its stdin, stdout and stderr as file descriptors. The server forks a
+// child per request from its already initialized state. The child takes
+// over those descriptors, so the script reads and writes the client's own
+// streams, and then sends back its exit status. Each request runs in its
+// own process: nothing one script does is seen by the next, and a crash
+// takes down only that request.
+
+// Runs a command line in a forked child, whose working directory and
+// standard streams are the client's; returns the exit status.
+using RequestHandler = std::function<int(const std::vector<std::string> &)>;
+
+// Serves requests until SIGINT or SIGTERM, then removes the socket.
+// Returns the server's own exit status.
+int serve(const std::string &socketPath, const RequestHandler &handler);
+
+// Has the server at socketPath run args and returns the exit status.
+int connectAndRun(const std::string &socketPath,
+                  const std::vector<std::string> &args);
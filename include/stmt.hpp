@@ -7,6 +7,9 @@
 #include <variant>
 #include <vector>
 
+class JitFunction;
+class MemoCache;
+
 struct Block;
 struct Class;
 struct Expression;
@@ -45,6 +48,12 @@ struct Func {
   std::vector<Token> params;
   std::vector<std::shared_ptr<Stmt>> body;
 
+  // Set by the memoize pass on functions proven pure.
+  std::shared_ptr<MemoCache> memo = nullptr;
+
+  // Set by the jit pass on functions it may compile to native code.
+  std::shared_ptr<JitFunction> jit = nullptr;
+
   Func(Token name, std::vector<Token> params,
        std::vector<std::shared_ptr<Stmt>> body)
       : name(name), params(params), body(body) {}
@@ -70,6 +79,10 @@ struct Return {
   Token keyword;
   std::shared_ptr<Expr> value;
 
+  // Set by the Resolver when value is a call in tail position, which the
+  // interpreter runs in the returning function's frame.
+  bool tailCall = false;
+
   Return(Token keyword, std::shared_ptr<Expr> value)
       : keyword(keyword), value(value) {}
 };
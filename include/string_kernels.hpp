@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// Byte-string kernels behind the string natives. They work 16 bytes at a
+// time with SSE2 where the compiler targets it, and a byte at a time
+// otherwise.
+
+// The offset of the first needle in haystack at or after from, or npos.
+size_t findBytes(std::string_view haystack, std::string_view needle,
+                 size_t from = 0);
+
+// Copies size bytes from in to out with ASCII letters changed in case;
+// other bytes, including UTF-8 sequences, are copied as they are.
+void toUpperBytes(const char *in, char *out, size_t size);
+void toLowerBytes(const char *in, char *out, size_t size);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running submitted tasks in FIFO order. Tasks
+// may submit more tasks; wait() returns once all of them have finished.
+class ThreadPool {
+private:
+  std::vector<std::thread> workers{};
+  std::deque<std::function<void()>> tasks{};
+  std::mutex mutex{};
+  std::condition_variable available{};
+  std::condition_variable idle{};
+  size_t running{0};
+  bool stopping{false};
+
+  void work();
+
+public:
+  // Zero threads means one per hardware thread.
+  ThreadPool(size_t threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void submit(std::function<void()> task);
+
+  void wait();
+};
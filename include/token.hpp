@@ -6,40 +6,62 @@
 #include <variant>
 
 class LoxCallable;
+class LoxString;
 class LoxInstance;
+class LoxList;
+class LoxMap;
+class NativeObject;
 
 using LiteralObject =
-    std::variant<std::monostate, std::string, double, bool,
-                 std::shared_ptr<LoxCallable>, std::shared_ptr<LoxInstance>>;
+    std::variant<std::monostate, std::shared_ptr<LoxString>, double, bool,
+                 std::shared_ptr<LoxCallable>, std::shared_ptr<LoxInstance>,
+                 std::shared_ptr<LoxList>, std::shared_ptr<LoxMap>,
+                 std::shared_ptr<NativeObject>>;
 
 struct StringifyLiteralVisitor {
   std::string operator()(std::monostate) const;
 
-  std::string operator()(std::string str) const;
+  std::string operator()(const std::shared_ptr<LoxString> &str) const;
 
   std::string operator()(double num) const;
 
   std::string operator()(bool val) const;
 
-  std::string operator()(std::shared_ptr<LoxCallable> callable) const;
+  std::string operator()(const std::shared_ptr<LoxCallable> &callable) const;
 
-  std::string operator()(std::shared_ptr<LoxInstance> instance) const;
+  std::string operator()(const std::shared_ptr<LoxInstance> &instance) const;
+
+  std::string operator()(const std::shared_ptr<LoxList> &list) const;
+
+  std::string operator()(const std::shared_ptr<LoxMap> &map) const;
+
+  std::string operator()(const std::shared_ptr<NativeObject> &object) const;
 };
 
 struct TruthyLiteralVisitor {
   bool operator()(std::monostate) const;
 
-  bool operator()(std::string str) const;
+  bool operator()(const std::shared_ptr<LoxString> &str) const;
 
   bool operator()(double num) const;
 
   bool operator()(bool val) const;
 
-  bool operator()(std::shared_ptr<LoxCallable> callable) const;
+  bool operator()(const std::shared_ptr<LoxCallable> &callable) const;
+
+  bool operator()(const std::shared_ptr<LoxInstance> &instance) const;
 
-  bool operator()(std::shared_ptr<LoxInstance> instance) const;
+  bool operator()(const std::shared_ptr<LoxList> &list) const;
+
+  bool operator()(const std::shared_ptr<LoxMap> &map) const;
+
+  bool operator()(const std::shared_ptr<NativeObject> &object) const;
 };
 
+// Value equality: strings compare by contents, everything else like the
+// underlying variant.
+bool isEqual(const LiteralObject &a, const LiteralObject &b);
+
 class Token {
 public:
   TokenType type;
@@ -6,6 +6,8 @@ enum class TokenType {
   RIGHT_PAREN,
   LEFT_BRACE,
   RIGHT_BRACE,
+  LEFT_BRACKET,
+  RIGHT_BRACKET,
   COMMA,
   DOT,
   MINUS,
@@ -37,6 +39,7 @@ enum class TokenType {
   FUN,
   FOR,
   IF,
+  IMPORT,
   NIL,
   OR,
   PRINT,
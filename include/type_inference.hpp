@@ -0,0 +1,112 @@
+#pragma once
+
+#include "expr.hpp"
+#include "interpreter.hpp"
+#include "pass.hpp"
+#include "stmt.hpp"
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Flow-sensitive type inference over resolved code. Runs after the Resolver
+// and marks Binary and Unary nodes whose operands are provably numbers (or
+// strings, for '+') so the interpreter can skip its operand checks.
+//
+// Only locals are tracked; globals and variables captured from an enclosing
+// function are unknown. A local assigned from inside a closure is pinned to
+// unknown from the closure's declaration onwards, since the closure may run
+// at any later call.
+class TypeInference : public Pass {
+private:
+  struct VarState {
+    StaticType type;
+    bool pinned;
+  };
+
+  using Scope = std::unordered_map<std::string, VarState>;
+
+  Interpreter &interpreter;
+  std::vector<Scope> scopes{};
+  size_t functionBase{0};
+
+  // Loop bodies are analysed repeatedly until their entry state settles;
+  // nodes are only marked on the final pass, once every enclosing loop has
+  // settled too.
+  bool marking{true};
+
+  size_t operatorNodes{0};
+  size_t provenNodes{0};
+
+  int scopeIndex(const std::optional<size_t> &id);
+  StaticType lookup(const std::optional<size_t> &id, const std::string &name);
+  void assign(const std::optional<size_t> &id, const std::string &name,
+              StaticType type);
+  void declare(const std::string &name, StaticType type);
+  void mark(StaticType &operandType, StaticType proven);
+
+  static StaticType join(StaticType a, StaticType b);
+  static std::vector<Scope> join(const std::vector<Scope> &a,
+                                 const std::vector<Scope> &b);
+  static bool sameState(const std::vector<Scope> &a,
+                        const std::vector<Scope> &b);
+
+public:
+  TypeInference(Interpreter &interpreter);
+
+  std::string name() const override;
+
+  void run(std::vector<std::shared_ptr<Stmt>> &statements) override;
+
+  void report(std::ostream &out) const override;
+
+  void operator()(Block &stmt);
+
+  void operator()(Class &stmt);
+
+  void operator()(Expression &stmt);
+
+  void operator()(Func &stmt);
+
+  void operator()(If &stmt);
+
+  void operator()(Print &stmt);
+
+  void operator()(Return &stmt);
+
+  void operator()(Var &stmt);
+
+  void operator()(While &stmt);
+
+  StaticType operator()(Assign &expr);
+
+  StaticType operator()(Logical &expr);
+
+  StaticType operator()(Binary &expr);
+
+  StaticType operator()(Call &expr);
+
+  StaticType operator()(Get &expr);
+
+  StaticType operator()(Set &expr);
+
+  StaticType operator()(Grouping &expr);
+
+  StaticType operator()(Literal &expr);
+
+  StaticType operator()(Unary &expr);
+
+  StaticType operator()(Variable &expr);
+
+  StaticType operator()(ListLiteral &expr);
+
+  StaticType operator()(Index &expr);
+
+  StaticType operator()(SetIndex &expr);
+
+  void analyze(std::vector<std::shared_ptr<Stmt>> &statements);
+
+  void analyze(std::shared_ptr<Stmt> statement);
+
+  StaticType analyze(std::shared_ptr<Expr> expr);
+};
@@ -79,6 +79,8 @@ def main():
         [
             "Assign= std::optional<size_t> id, Token name, std::shared_ptr<Expr> value",
             "Logical= std::optional<size_t> id, std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right",
+            # Binary is the shared base of the per-operator BinaryOp<OP> nodes;
+            # the template and its aliases in expr.hpp are maintained by hand.
             "Binary= std::optional<size_t> id, std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right",
             "Call= std::optional<size_t> id, std::shared_ptr<Expr> callee, Token paren, std::vector<std::shared_ptr<Expr>> args",
             "Get= std::shared_ptr<Expr> object, Token name",
@@ -87,6 +89,9 @@ def main():
             "Literal= std::optional<size_t> id, LiteralObject value",
             "Unary= std::optional<size_t> id, Token op, std::shared_ptr<Expr> right",
             "Variable= std::optional<size_t> id, Token name",
+            "ListLiteral= Token bracket, std::vector<std::shared_ptr<Expr>> elements",
+            "Index= std::shared_ptr<Expr> object, Token bracket, std::shared_ptr<Expr> index",
+            "SetIndex= std::shared_ptr<Expr> object, Token bracket, std::shared_ptr<Expr> index, std::shared_ptr<Expr> value",
         ],
     )
 
@@ -97,9 +102,11 @@ def main():
             "Block= std::vector<std::shared_ptr<Stmt>> statements",
             "Class= Token name, std::vector<Func> methods",
             "Expression= std::shared_ptr<Expr> expr",
+            # Func also has memo cache and jit pointers, added by hand in stmt.hpp.
             "Func= Token name, std::vector<Token> params, std::vector<std::shared_ptr<Stmt>> body",
             "If= std::shared_ptr<Expr> condition, std::shared_ptr<Stmt> thenBranch, std::shared_ptr<Stmt> elseBranch",
             "Print= std::shared_ptr<Expr> expr",
+            # Return also has a tailCall flag, added by hand in stmt.hpp.
             "Return= Token keyword, std::shared_ptr<Expr> value",
             "Var= Token name, std::shared_ptr<Expr> initializer",
             "While= std::shared_ptr<Expr> condition, std::shared_ptr<Stmt> body",
@@ -0,0 +1,73 @@
+"""Measures per-request latency and throughput of running scripts.
+
+Runs a script a number of times, several at once, and reports requests per
+second and latency percentiles. Without --socket every request starts a new
+CppLox process; with it, requests go through `CppLox --connect` to a server
+started with `CppLox --serve <socket>`.
+
+    python3 scripts/LoadGen.py --binary build/CppLox --requests 500 \\
+        --concurrency 4 --socket /tmp/lox.sock script.lox
+"""
+
+import argparse
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+from typing import List
+
+
+def runOnce(command: List[str]) -> float:
+    start = time.perf_counter()
+    result = subprocess.run(
+        command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL
+    )
+    elapsed = time.perf_counter() - start
+
+    if result.returncode != 0:
+        raise RuntimeError(f"{' '.join(command)} exited with {result.returncode}")
+
+    return elapsed
+
+
+def percentile(sorted_values: List[float], fraction: float) -> float:
+    index = min(len(sorted_values) - 1, int(fraction * len(sorted_values)))
+    return sorted_values[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--binary", default="build/CppLox")
+    parser.add_argument("--socket", help="server socket; cold starts if omitted")
+    parser.add_argument("--requests", type=int, default=200)
+    parser.add_argument("--concurrency", type=int, default=1)
+    parser.add_argument("script", nargs=argparse.REMAINDER)
+    args = parser.parse_args()
+
+    if not args.script:
+        parser.error("no script given")
+
+    command = [args.binary]
+    if args.socket:
+        command += ["--connect", args.socket]
+    command += args.script
+
+    start = time.perf_counter()
+
+    with ThreadPoolExecutor(max_workers=args.concurrency) as pool:
+        latencies = sorted(pool.map(lambda _: runOnce(command), range(args.requests)))
+
+    total = time.perf_counter() - start
+
+    print(f"mode:        {'server' if args.socket else 'cold start'}")
+    print(f"requests:    {args.requests} ({args.concurrency} at a time)")
+    print(f"throughput:  {args.requests / total:.1f} requests/s")
+
+    for name, fraction in (("p50", 0.5), ("p90", 0.9), ("p99", 0.99)):
+        print(f"{name}:         {percentile(latencies, fraction) * 1000:.2f} ms")
+
+    print(f"max:         {latencies[-1] * 1000:.2f} ms")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,82 @@
+import argparse
+import pathlib
+import re
+import subprocess
+import sys
+
+EXPECT = re.compile(r"// expect: ?(.*)")
+EXPECT_RUNTIME_ERROR = re.compile(r"// expect runtime error: (.+)")
+
+
+# The output a test script should print, from its comments: each
+# "// expect: <line>" is a line of output, and a
+# "// expect runtime error: <message>" is the message and the line it is
+# reported on, after which the script has to exit with a failure.
+def expectations(script: pathlib.Path):
+    lines = []
+    fails = False
+
+    for number, text in enumerate(script.read_text().splitlines(), 1):
+        match = EXPECT.search(text)
+
+        if match:
+            lines.append(match.group(1))
+
+        match = EXPECT_RUNTIME_ERROR.search(text)
+
+        if match:
+            lines.append(match.group(1))
+            lines.append(f"[line {number}]")
+            fails = True
+
+    return lines, fails
+
+
+def run(binary: str, script: pathlib.Path) -> bool:
+    expected, fails = expectations(script)
+    # From the script's directory, so it can open files next to it.
+    result = subprocess.run([binary, str(script.resolve())],
+                            cwd=script.parent, capture_output=True, text=True,
+                            timeout=60)
+    actual = result.stdout.splitlines()
+
+    if actual == expected and (result.returncode != 0) == fails:
+        return True
+
+    print(f"FAIL {script}")
+    print(f"  exit status {result.returncode}")
+
+    for line in expected:
+        print(f"  expected: {line}")
+
+    for line in actual:
+        print(f"  actual:   {line}")
+
+    if result.stderr:
+        print(f"  stderr:   {result.stderr.strip()}")
+
+    return False
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run Lox test scripts and check their output.")
+    parser.add_argument("binary", help="path to CppLox")
+    parser.add_argument("tests", nargs="?", default=str(
+        pathlib.Path(__file__).resolve().parent.parent / "tests"),
+        help="directory of .lox test scripts")
+    args = parser.parse_args()
+
+    # Modules the tests import live in lib directories and aren't tests.
+    tests = pathlib.Path(args.tests)
+    scripts = sorted(script for script in tests.rglob("*.lox")
+                     if "lib" not in script.relative_to(tests).parts)
+    binary = str(pathlib.Path(args.binary).resolve())
+    failed = [script for script in scripts if not run(binary, script)]
+
+    print(f"{len(scripts) - len(failed)} of {len(scripts)} passed")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,229 @@
+#include "aot_runtime.hpp"
+#include "error_reporter.hpp"
+#include "lox_float64_array.hpp"
+#include "lox_list.hpp"
+#include "lox_map.hpp"
+#include "lox_string.hpp"
+#include "output.hpp"
+#include "runtime_error.hpp"
+#include <cstdlib>
+#include <cstring>
+
+extern ErrorReporter errorReporter;
+extern Output output;
+
+// AotFunction
+
+AotFunction::AotFunction(std::string name, int params, Body body,
+                         std::shared_ptr<Environment> closure)
+    : name(name), params(params), body(body), closure(closure) {}
+
+int AotFunction::arity() { return params; }
+
+LiteralObject AotFunction::call(Interpreter &interpreter,
+                                std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxCallable> tailCallee{};
+  AotFunction *function = this;
+
+  while (true) {
+    LiteralObject result =
+        function->body(interpreter, function->closure, args);
+
+    if (interpreter.tailCallee == nullptr)
+      return result;
+
+    tailCallee = std::move(interpreter.tailCallee);
+    function = static_cast<AotFunction *>(tailCallee.get());
+    args.swap(interpreter.tailArgs);
+  }
+}
+
+std::string AotFunction::toString() const { return "<fn " + name + ">"; }
+
+// AotRuntime
+
+int AotRuntime::main(void (*script)(Interpreter &interpreter)) {
+  Interpreter interpreter{};
+
+  try {
+    script(interpreter);
+  } catch (RuntimeError *error) {
+    errorReporter.runtimeError(error);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+LiteralObject AotRuntime::number(uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+LiteralObject AotRuntime::string(const char *chars, size_t length) {
+  return std::make_shared<LoxString>(std::string(chars, length));
+}
+
+LiteralObject AotRuntime::negate(const Token &op, const LiteralObject &value) {
+  checkNumberOperand(op, value);
+  return -std::get<double>(value);
+}
+
+// Checks the callee the way Interpreter::evaluateCall does.
+static std::shared_ptr<LoxCallable> callable(const Token &paren,
+                                             const LiteralObject &callee,
+                                             size_t args) {
+  if (!std::holds_alternative<std::shared_ptr<LoxCallable>>(callee))
+    throw new RuntimeError(paren, "Can only call functions and classes.");
+
+  std::shared_ptr<LoxCallable> function =
+      std::get<std::shared_ptr<LoxCallable>>(callee);
+
+  if (args != function->arity()) {
+    throw new RuntimeError(
+        paren, "Expected " + std::to_string(function->arity()) +
+                   " args, got " + std::to_string(args) + ".");
+  }
+
+  return function;
+}
+
+LiteralObject AotRuntime::call(Interpreter &interpreter, const Token &paren,
+                               const LiteralObject &callee,
+                               std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxCallable> function = callable(paren, callee, args.size());
+
+  try {
+    return function->call(interpreter, std::move(args));
+  } catch (NativeError *error) {
+    throw new RuntimeError(paren, error->message);
+  }
+}
+
+LiteralObject AotRuntime::tailCall(Interpreter &interpreter,
+                                   const Token &paren,
+                                   const LiteralObject &callee,
+                                   std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxCallable> function = callable(paren, callee, args.size());
+
+  if (dynamic_cast<AotFunction *>(function.get()) != nullptr) {
+    interpreter.tailCallee = std::move(function);
+    interpreter.tailArgs = std::move(args);
+    return std::monostate{};
+  }
+
+  try {
+    return function->call(interpreter, std::move(args));
+  } catch (NativeError *error) {
+    throw new RuntimeError(paren, error->message);
+  }
+}
+
+LiteralObject AotRuntime::function(std::string name, int params,
+                                   AotFunction::Body body,
+                                   std::shared_ptr<Environment> closure) {
+  return std::shared_ptr<LoxCallable>(
+      std::make_shared<AotFunction>(name, params, body, closure));
+}
+
+LiteralObject AotRuntime::klass(std::string name) {
+  return std::shared_ptr<LoxCallable>(std::make_shared<LoxClass>(name));
+}
+
+LiteralObject AotRuntime::get(const Token &name, const LiteralObject &object) {
+  if (std::holds_alternative<std::shared_ptr<LoxInstance>>(object))
+    return std::get<std::shared_ptr<LoxInstance>>(object)->get(name);
+
+  throw new RuntimeError(name, "Only instances have properties.");
+}
+
+void AotRuntime::checkFields(const Token &name, const LiteralObject &object) {
+  if (!std::holds_alternative<std::shared_ptr<LoxInstance>>(object))
+    throw new RuntimeError(name, "Only instances have fields.");
+}
+
+void AotRuntime::set(const Token &name, const LiteralObject &object,
+                     const LiteralObject &value) {
+  std::get<std::shared_ptr<LoxInstance>>(object)->set(name, value);
+}
+
+LiteralObject AotRuntime::list(std::vector<LiteralObject> elements) {
+  std::shared_ptr<LoxList> list = std::make_shared<LoxList>();
+  list->elements = std::move(elements);
+  return list;
+}
+
+LiteralObject AotRuntime::index(const Token &bracket,
+                                const LiteralObject &object,
+                                const LiteralObject &index) {
+  if (std::holds_alternative<std::shared_ptr<LoxMap>>(object)) {
+    checkMapKey(bracket, index);
+    LiteralObject *value =
+        std::get<std::shared_ptr<LoxMap>>(object)->find(index);
+    return value ? *value : std::monostate{};
+  }
+
+  if (std::shared_ptr<LoxFloat64Array> array = asFloat64Array(object))
+    return array->data[checkIndex(bracket, index, array->size)];
+
+  if (!std::holds_alternative<std::shared_ptr<LoxList>>(object)) {
+    throw new RuntimeError(bracket,
+                           "Only lists, maps and Float64Arrays can be "
+                           "indexed.");
+  }
+
+  std::vector<LiteralObject> &elements =
+      std::get<std::shared_ptr<LoxList>>(object)->elements;
+
+  return elements[checkIndex(bracket, index, elements.size())];
+}
+
+void AotRuntime::checkIndexed(const Token &bracket,
+                              const LiteralObject &object,
+                              const LiteralObject &index) {
+  if (std::holds_alternative<std::shared_ptr<LoxMap>>(object)) {
+    checkMapKey(bracket, index);
+    return;
+  }
+
+  if (std::shared_ptr<LoxFloat64Array> array = asFloat64Array(object)) {
+    checkIndex(bracket, index, array->size);
+    return;
+  }
+
+  if (!std::holds_alternative<std::shared_ptr<LoxList>>(object)) {
+    throw new RuntimeError(bracket,
+                           "Only lists, maps and Float64Arrays can be "
+                           "indexed.");
+  }
+
+  checkIndex(bracket, index,
+             std::get<std::shared_ptr<LoxList>>(object)->elements.size());
+}
+
+void AotRuntime::setIndex(const Token &bracket, const LiteralObject &object,
+                          const LiteralObject &index,
+                          const LiteralObject &value) {
+  if (std::holds_alternative<std::shared_ptr<LoxMap>>(object)) {
+    std::get<std::shared_ptr<LoxMap>>(object)->set(index, value);
+    return;
+  }
+
+  if (std::shared_ptr<LoxFloat64Array> array = asFloat64Array(object)) {
+    checkFloat64Element(bracket, value);
+    array->data[checkIndex(bracket, index, array->size)] =
+        std::get<double>(value);
+    return;
+  }
+
+  std::vector<LiteralObject> &elements =
+      std::get<std::shared_ptr<LoxList>>(object)->elements;
+
+  // The value's evaluation may have shrunk the list since it was checked.
+  elements[checkIndex(bracket, index, elements.size())] = value;
+}
+
+void AotRuntime::print(const LiteralObject &value) {
+  output.print(std::visit(StringifyLiteralVisitor{}, value));
+}
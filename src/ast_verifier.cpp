@@ -0,0 +1,147 @@
+#include "ast_verifier.hpp"
+#include <memory>
+#include <variant>
+
+void AstVerifier::verify(std::vector<std::shared_ptr<Stmt>> &statements) {
+  for (std::shared_ptr<Stmt> &stmt : statements) {
+    check(stmt, "top-level statement");
+  }
+}
+
+void AstVerifier::check(std::shared_ptr<Stmt> stmt, std::string what) {
+  if (stmt == nullptr) {
+    errors.push_back("missing " + what);
+    return;
+  }
+
+  nodes++;
+  std::visit(*this, *stmt);
+}
+
+void AstVerifier::check(std::shared_ptr<Expr> expr, std::string what) {
+  if (expr == nullptr) {
+    errors.push_back("missing " + what);
+    return;
+  }
+
+  nodes++;
+  std::visit(*this, *expr);
+}
+
+void AstVerifier::checkResolved(const std::optional<size_t> &id,
+                                const Token &name) {
+  if (!id.has_value()) {
+    errors.push_back("unresolved variable '" + name.lexeme + "' on line " +
+                     std::to_string(name.line));
+  }
+}
+
+// Statements
+
+void AstVerifier::operator()(Block &stmt) {
+  for (std::shared_ptr<Stmt> &inner : stmt.statements) {
+    check(inner, "statement in block");
+  }
+}
+
+void AstVerifier::operator()(Class &stmt) {}
+
+void AstVerifier::operator()(Expression &stmt) {
+  check(stmt.expr, "expression statement's expression");
+}
+
+void AstVerifier::operator()(Func &stmt) {
+  for (std::shared_ptr<Stmt> &inner : stmt.body) {
+    check(inner, "statement in body of '" + stmt.name.lexeme + "'");
+  }
+}
+
+void AstVerifier::operator()(If &stmt) {
+  check(stmt.condition, "if condition");
+  check(stmt.thenBranch, "if branch");
+
+  if (stmt.elseBranch != nullptr)
+    check(stmt.elseBranch, "else branch");
+}
+
+void AstVerifier::operator()(Print &stmt) { check(stmt.expr, "printed value"); }
+
+void AstVerifier::operator()(Return &stmt) {
+  if (stmt.value != nullptr)
+    check(stmt.value, "return value");
+}
+
+void AstVerifier::operator()(Var &stmt) {
+  if (stmt.initializer != nullptr)
+    check(stmt.initializer, "initializer of '" + stmt.name.lexeme + "'");
+}
+
+void AstVerifier::operator()(While &stmt) {
+  check(stmt.condition, "while condition");
+  check(stmt.body, "while body");
+}
+
+// Expressions
+
+void AstVerifier::operator()(Assign &expr) {
+  checkResolved(expr.id, expr.name);
+  check(expr.value, "assigned value");
+}
+
+void AstVerifier::operator()(Logical &expr) {
+  check(expr.left, "left operand of '" + expr.op.lexeme + "'");
+  check(expr.right, "right operand of '" + expr.op.lexeme + "'");
+}
+
+void AstVerifier::operator()(Binary &expr) {
+  check(expr.left, "left operand of '" + expr.op.lexeme + "'");
+  check(expr.right, "right operand of '" + expr.op.lexeme + "'");
+}
+
+void AstVerifier::operator()(Call &expr) {
+  check(expr.callee, "callee");
+
+  for (std::shared_ptr<Expr> &arg : expr.args) {
+    check(arg, "call argument");
+  }
+}
+
+void AstVerifier::operator()(Get &expr) {
+  check(expr.object, "object of '." + expr.name.lexeme + "'");
+}
+
+void AstVerifier::operator()(Set &expr) {
+  check(expr.object, "object of '." + expr.name.lexeme + "'");
+  check(expr.value, "value assigned to '." + expr.name.lexeme + "'");
+}
+
+void AstVerifier::operator()(Grouping &expr) {
+  check(expr.expression, "grouped expression");
+}
+
+void AstVerifier::operator()(Literal &expr) {}
+
+void AstVerifier::operator()(Unary &expr) {
+  check(expr.right, "operand of '" + expr.op.lexeme + "'");
+}
+
+void AstVerifier::operator()(Variable &expr) {
+  checkResolved(expr.id, expr.name);
+}
+
+void AstVerifier::operator()(ListLiteral &expr) {
+  for (std::shared_ptr<Expr> &element : expr.elements) {
+    check(element, "list element");
+  }
+}
+
+void AstVerifier::operator()(Index &expr) {
+  check(expr.object, "indexed object");
+  check(expr.index, "index");
+}
+
+void AstVerifier::operator()(SetIndex &expr) {
+  check(expr.object, "indexed object");
+  check(expr.index, "index");
+  check(expr.value, "value assigned to index");
+}
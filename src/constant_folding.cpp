@@ -0,0 +1,248 @@
+#include "constant_folding.hpp"
+#include "interpreter.hpp"
+#include "runtime_error.hpp"
+#include <memory>
+#include <variant>
+
+std::string ConstantFolding::name() const { return "constant-folding"; }
+
+void ConstantFolding::run(std::vector<std::shared_ptr<Stmt>> &statements) {
+  fold(statements);
+}
+
+void ConstantFolding::report(std::ostream &out) const {
+  out << "constant folding: " << foldedExprs << " expressions folded, "
+      << removedBranches << " branches removed\n";
+}
+
+void ConstantFolding::fold(std::vector<std::shared_ptr<Stmt>> &statements) {
+  for (std::shared_ptr<Stmt> &stmt : statements) {
+    fold(stmt);
+  }
+}
+
+void ConstantFolding::fold(std::shared_ptr<Stmt> &stmt) {
+  if (stmt == nullptr)
+    return;
+
+  std::shared_ptr<Stmt> replacement = std::visit(*this, *stmt);
+
+  if (replacement != nullptr)
+    stmt = replacement;
+}
+
+void ConstantFolding::fold(std::shared_ptr<Expr> &expr) {
+  if (expr == nullptr)
+    return;
+
+  std::shared_ptr<Expr> replacement = std::visit(*this, *expr);
+
+  if (replacement != nullptr)
+    expr = replacement;
+}
+
+const LiteralObject *
+ConstantFolding::constant(const std::shared_ptr<Expr> &expr) {
+  if (Literal *literal = std::get_if<Literal>(expr.get()))
+    return &literal->value;
+
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::literal(LiteralObject value) {
+  foldedExprs++;
+  return std::make_shared<Expr>(Literal(std::move(value)));
+}
+
+// Statements
+
+std::shared_ptr<Stmt> ConstantFolding::operator()(Block &stmt) {
+  fold(stmt.statements);
+  return nullptr;
+}
+
+std::shared_ptr<Stmt> ConstantFolding::operator()(Class &stmt) {
+  for (Func &method : stmt.methods) {
+    (*this)(method);
+  }
+
+  return nullptr;
+}
+
+std::shared_ptr<Stmt> ConstantFolding::operator()(Expression &stmt) {
+  fold(stmt.expr);
+  return nullptr;
+}
+
+std::shared_ptr<Stmt> ConstantFolding::operator()(Func &stmt) {
+  fold(stmt.body);
+  return nullptr;
+}
+
+std::shared_ptr<Stmt> ConstantFolding::operator()(If &stmt) {
+  fold(stmt.condition);
+  fold(stmt.thenBranch);
+  fold(stmt.elseBranch);
+
+  const LiteralObject *condition = constant(stmt.condition);
+
+  if (condition == nullptr)
+    return nullptr;
+
+  removedBranches++;
+
+  if (std::visit(TruthyLiteralVisitor{}, *condition))
+    return stmt.thenBranch;
+
+  if (stmt.elseBranch != nullptr)
+    return stmt.elseBranch;
+
+  return std::make_shared<Stmt>(Block({}));
+}
+
+std::shared_ptr<Stmt> ConstantFolding::operator()(Print &stmt) {
+  fold(stmt.expr);
+  return nullptr;
+}
+
+std::shared_ptr<Stmt> ConstantFolding::operator()(Return &stmt) {
+  fold(stmt.value);
+  return nullptr;
+}
+
+std::shared_ptr<Stmt> ConstantFolding::operator()(Var &stmt) {
+  fold(stmt.initializer);
+  return nullptr;
+}
+
+std::shared_ptr<Stmt> ConstantFolding::operator()(While &stmt) {
+  fold(stmt.condition);
+  fold(stmt.body);
+
+  const LiteralObject *condition = constant(stmt.condition);
+
+  if (condition == nullptr || std::visit(TruthyLiteralVisitor{}, *condition))
+    return nullptr;
+
+  removedBranches++;
+  return std::make_shared<Stmt>(Block({}));
+}
+
+// Expressions
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Assign &expr) {
+  fold(expr.value);
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Logical &expr) {
+  fold(expr.left);
+  fold(expr.right);
+
+  const LiteralObject *left = constant(expr.left);
+
+  if (left == nullptr)
+    return nullptr;
+
+  bool truthy = std::visit(TruthyLiteralVisitor{}, *left);
+  bool shortCircuits = expr.op.type == TokenType::OR ? truthy : !truthy;
+
+  foldedExprs++;
+  return shortCircuits ? expr.left : expr.right;
+}
+
+template <TokenType OP>
+std::shared_ptr<Expr> ConstantFolding::operator()(BinaryOp<OP> &expr) {
+  fold(expr.left);
+  fold(expr.right);
+
+  const LiteralObject *left = constant(expr.left);
+  const LiteralObject *right = constant(expr.right);
+
+  if (left == nullptr || right == nullptr)
+    return nullptr;
+
+  try {
+    return literal(Interpreter::genericOp<OP>(expr.op, *left, *right));
+  } catch (RuntimeError *error) {
+    delete error;
+    return nullptr;
+  }
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Call &expr) {
+  fold(expr.callee);
+
+  for (std::shared_ptr<Expr> &arg : expr.args) {
+    fold(arg);
+  }
+
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Get &expr) {
+  fold(expr.object);
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Set &expr) {
+  fold(expr.object);
+  fold(expr.value);
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Grouping &expr) {
+  fold(expr.expression);
+
+  if (constant(expr.expression) == nullptr)
+    return nullptr;
+
+  foldedExprs++;
+  return expr.expression;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Literal &expr) {
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Unary &expr) {
+  fold(expr.right);
+
+  const LiteralObject *right = constant(expr.right);
+
+  if (right == nullptr)
+    return nullptr;
+
+  if (expr.op.type == TokenType::BANG)
+    return literal(!std::visit(TruthyLiteralVisitor{}, *right));
+
+  if (const double *number = std::get_if<double>(right))
+    return literal(-*number);
+
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Variable &expr) {
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(ListLiteral &expr) {
+  for (std::shared_ptr<Expr> &element : expr.elements) {
+    fold(element);
+  }
+
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(Index &expr) {
+  fold(expr.object);
+  fold(expr.index);
+  return nullptr;
+}
+
+std::shared_ptr<Expr> ConstantFolding::operator()(SetIndex &expr) {
+  fold(expr.object);
+  fold(expr.index);
+  fold(expr.value);
+  return nullptr;
+}
@@ -0,0 +1,605 @@
+#include "cpp_emitter.hpp"
+#include "lox_string.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+CppEmitter::CppEmitter(Interpreter &interpreter) : interpreter(interpreter) {}
+
+void CppEmitter::line(const std::string &text) {
+  *out << std::string(indent * 2, ' ') << text << "\n";
+}
+
+std::string CppEmitter::temp(const std::string &value) {
+  std::string name = "t" + std::to_string(temps++);
+  line("LiteralObject " + name + " = " + value + ";");
+  return name;
+}
+
+std::string CppEmitter::token(const Token &token) {
+  auto key = std::make_tuple(static_cast<int>(token.type), token.lexeme,
+                             token.line);
+  auto [it, inserted] = tokens.emplace(key, tokens.size());
+  return "tokens[" + std::to_string(it->second) + "]";
+}
+
+std::string CppEmitter::literal(const LiteralObject &value) {
+  if (const double *number = std::get_if<double>(&value)) {
+    char text[64];
+
+    if (std::isfinite(*number)) {
+      std::snprintf(text, sizeof(text), "%a", *number);
+      return text;
+    }
+
+    uint64_t bits;
+    std::memcpy(&bits, number, sizeof(bits));
+    std::snprintf(text, sizeof(text), "AotRuntime::number(0x%llxULL)",
+                  static_cast<unsigned long long>(bits));
+    return text;
+  }
+
+  if (const bool *boolean = std::get_if<bool>(&value))
+    return *boolean ? "true" : "false";
+
+  if (const auto *string = std::get_if<std::shared_ptr<LoxString>>(&value)) {
+    const std::string &chars = (*string)->str();
+    auto [it, inserted] = strings.emplace(chars, strings.size());
+    return "strings[" + std::to_string(it->second) + "]";
+  }
+
+  return "LiteralObject{}";
+}
+
+std::string CppEmitter::quote(const std::string &chars) {
+  std::string quoted = "\"";
+
+  for (unsigned char c : chars) {
+    if (c >= ' ' && c <= '~' && c != '"' && c != '\\' && c != '?') {
+      quoted += c;
+      continue;
+    }
+
+    char escape[8];
+    std::snprintf(escape, sizeof(escape), "\\%03o", c);
+    quoted += escape;
+  }
+
+  return quoted + "\"";
+}
+
+// Scopes
+
+size_t CppEmitter::function() const { return closures.size(); }
+
+bool CppEmitter::isLocal(const std::optional<size_t> &id) const {
+  return id.has_value() && interpreter.locals.count(id.value());
+}
+
+const CppEmitter::Binding *CppEmitter::lookUp(const std::string &name) {
+  for (auto scope = scopes.rbegin(); scope != scopes.rend(); scope++) {
+    auto binding = scope->bindings.find(name);
+
+    if (binding != scope->bindings.end())
+      return &binding->second;
+  }
+
+  return nullptr;
+}
+
+std::string CppEmitter::environment(const Binding &binding,
+                                    int &distance) const {
+  if (binding.function == function()) {
+    distance = 0;
+    return environments[binding.env].name;
+  }
+
+  // Every environment is created inside the one before it, so the closure
+  // of the current function is closures.back() environments deep.
+  distance = closures.back() - binding.env;
+  return "closure";
+}
+
+std::string CppEmitter::currentEnvironment() const {
+  if (!environments.empty() && environments.back().function == function())
+    return environments.back().name;
+
+  return "closure";
+}
+
+bool CppEmitter::needsEnvironment(
+    const std::vector<std::shared_ptr<Stmt>> &statements,
+    const Func *params) const {
+  if (params != nullptr) {
+    for (const Token &param : params->params) {
+      if (captured.count(&param))
+        return true;
+    }
+  }
+
+  for (const std::shared_ptr<Stmt> &stmt : statements) {
+    const void *decl = nullptr;
+
+    if (Var *var = std::get_if<Var>(stmt.get()))
+      decl = var;
+    else if (Func *func = std::get_if<Func>(stmt.get()))
+      decl = func;
+    else if (Class *klass = std::get_if<Class>(stmt.get()))
+      decl = klass;
+
+    if (decl != nullptr && captured.count(decl))
+      return true;
+  }
+
+  return false;
+}
+
+void CppEmitter::beginScope(bool environment) {
+  Scope scope{{}, -1};
+
+  if (environment) {
+    std::string name = "e" + std::to_string(variables++);
+    line("std::shared_ptr<Environment> " + name +
+         " = std::make_shared<Environment>(" + currentEnvironment() + ");");
+    environments.push_back({name, function()});
+    scope.env = environments.size() - 1;
+  }
+
+  scopes.push_back(scope);
+}
+
+void CppEmitter::endScope() {
+  if (scopes.back().env >= 0)
+    environments.pop_back();
+
+  scopes.pop_back();
+}
+
+void CppEmitter::declare(const void *decl, const Token &name) {
+  if (scopes.empty())
+    return;
+
+  Scope &scope = scopes.back();
+  Binding binding{decl, "", function(), -1};
+
+  if (captured.count(decl) && scope.env >= 0)
+    binding.env = scope.env;
+  else
+    binding.name = "v" + std::to_string(variables++);
+
+  scope.bindings[name.lexeme] = binding;
+}
+
+void CppEmitter::initialize(const Token &name, const std::string &value) {
+  if (scopes.empty()) {
+    line("interpreter.globals->define(" + quote(name.lexeme) + ", " + value +
+         ");");
+    return;
+  }
+
+  const Binding &binding = scopes.back().bindings.at(name.lexeme);
+
+  if (binding.env >= 0) {
+    line(environments[binding.env].name + "->define(" + quote(name.lexeme) +
+         ", " + value + ");");
+  } else {
+    line("LiteralObject " + binding.name + " = " + value + ";");
+  }
+}
+
+std::string CppEmitter::load(const Token &name,
+                             const std::optional<size_t> &id) {
+  const Binding *binding = isLocal(id) ? lookUp(name.lexeme) : nullptr;
+
+  if (binding == nullptr)
+    return temp("interpreter.globals->get(" + token(name) + ")");
+
+  if (binding->function != function())
+    captured.insert(binding->decl);
+
+  if (binding->env < 0)
+    return temp(binding->name);
+
+  int distance;
+  std::string env = environment(*binding, distance);
+  return temp(env + "->getAt(" + std::to_string(distance) + ", " +
+              token(name) + ")");
+}
+
+void CppEmitter::store(const Token &name, const std::optional<size_t> &id,
+                       const std::string &value) {
+  const Binding *binding = isLocal(id) ? lookUp(name.lexeme) : nullptr;
+
+  if (binding == nullptr) {
+    line("interpreter.globals->assign(" + token(name) + ", " + value + ");");
+    return;
+  }
+
+  if (binding->function != function())
+    captured.insert(binding->decl);
+
+  if (binding->env < 0) {
+    line(binding->name + " = " + value + ";");
+    return;
+  }
+
+  int distance;
+  std::string env = environment(*binding, distance);
+  line(env + "->assignAt(" + std::to_string(distance) + ", " + token(name) +
+       ", " + value + ");");
+}
+
+// Translation
+
+std::string CppEmitter::emit(Expr &expr) { return std::visit(*this, expr); }
+
+void CppEmitter::emit(Stmt &stmt) { std::visit(*this, stmt); }
+
+std::string CppEmitter::emitFunction(Func &func) {
+  std::string name = "f" + std::to_string(variables++);
+  std::ostringstream body{};
+  std::ostringstream *enclosing = out;
+  int enclosingIndent = indent;
+
+  out = &body;
+  indent = 0;
+  line("// fun " + func.name.lexeme + " (line " +
+       std::to_string(func.name.line) + ")");
+  line("static LiteralObject " + name +
+       "(Interpreter &interpreter, const std::shared_ptr<Environment> "
+       "&closure, std::vector<LiteralObject> &args) {");
+  indent++;
+
+  closures.push_back(static_cast<int>(environments.size()) - 1);
+  beginScope(needsEnvironment(func.body, &func));
+
+  for (size_t i = 0; i < func.params.size(); i++) {
+    declare(&func.params[i], func.params[i]);
+    initialize(func.params[i], "std::move(args[" + std::to_string(i) + "])");
+  }
+
+  for (std::shared_ptr<Stmt> &stmt : func.body) {
+    emit(*stmt);
+  }
+
+  line("return LiteralObject{};");
+  endScope();
+  closures.pop_back();
+
+  indent--;
+  line("}");
+  functions.push_back(body.str());
+
+  out = enclosing;
+  indent = enclosingIndent;
+  return name;
+}
+
+std::string CppEmitter::emitArgs(std::vector<std::shared_ptr<Expr>> &args) {
+  std::string values{};
+
+  for (std::shared_ptr<Expr> &arg : args) {
+    values += (values.empty() ? "" : ", ") + emit(*arg);
+  }
+
+  return "{" + values + "}";
+}
+
+void CppEmitter::translate(std::vector<std::shared_ptr<Stmt>> &statements,
+                           std::ostringstream &script) {
+  temps = 0;
+  variables = 0;
+  functions.clear();
+  tokens.clear();
+  strings.clear();
+
+  out = &script;
+  indent = 0;
+  line("static void script(Interpreter &interpreter) {");
+  indent++;
+  line("const std::shared_ptr<Environment> &closure = interpreter.globals;");
+
+  for (std::shared_ptr<Stmt> &stmt : statements) {
+    emit(*stmt);
+  }
+
+  indent--;
+  line("}");
+}
+
+void CppEmitter::emit(std::vector<std::shared_ptr<Stmt>> &statements,
+                      std::ostream &output) {
+  std::ostringstream analysis{};
+  translate(statements, analysis);
+
+  std::ostringstream script{};
+  translate(statements, script);
+
+  output << "// Generated by CppLox --emit-cpp. Build it against the "
+            "LoxRuntime library:\n"
+         << "//   c++ -std=c++17 -O2 -I<CppLox>/include <this file> "
+            "<build>/libLoxRuntime.a\n\n"
+         << "#include \"aot_runtime.hpp\"\n"
+         << "#include \"environment.hpp\"\n"
+         << "#include \"error_reporter.hpp\"\n"
+         << "#include \"options.hpp\"\n"
+         << "#include \"output.hpp\"\n"
+         << "#include \"token.hpp\"\n"
+         << "#include <memory>\n"
+         << "#include <utility>\n"
+         << "#include <vector>\n\n"
+         << "ErrorReporter errorReporter{};\n"
+         << "Options options{};\n"
+         << "Output output{};\n\n";
+
+  if (!tokens.empty()) {
+    std::vector<std::string> table(tokens.size());
+
+    for (const auto &[key, index] : tokens) {
+      const auto &[type, lexeme, line] = key;
+      table[index] = "Token(static_cast<TokenType>(" + std::to_string(type) +
+                     "), " + quote(lexeme) + ", std::monostate{}, " +
+                     std::to_string(line) + ")";
+    }
+
+    output << "static const Token tokens[] = {\n";
+
+    for (const std::string &entry : table) {
+      output << "    " << entry << ",\n";
+    }
+
+    output << "};\n\n";
+  }
+
+  if (!strings.empty()) {
+    std::vector<std::string> table(strings.size());
+
+    for (const auto &[chars, index] : strings) {
+      table[index] = "AotRuntime::string(" + quote(chars) + ", " +
+                     std::to_string(chars.size()) + ")";
+    }
+
+    output << "static const LiteralObject strings[] = {\n";
+
+    for (const std::string &entry : table) {
+      output << "    " << entry << ",\n";
+    }
+
+    output << "};\n\n";
+  }
+
+  for (const std::string &function : functions) {
+    output << function << "\n";
+  }
+
+  output << script.str() << "\n"
+         << "int main() { return AotRuntime::main(script); }\n";
+}
+
+// Expressions
+
+std::string CppEmitter::operator()(Assign &expr) {
+  std::string value = emit(*expr.value);
+  store(expr.name, expr.id, value);
+  return value;
+}
+
+std::string CppEmitter::operator()(Logical &expr) {
+  std::string result = temp(emit(*expr.left));
+
+  if (expr.op.type == TokenType::OR)
+    line("if (!AotRuntime::truthy(" + result + ")) {");
+  else
+    line("if (AotRuntime::truthy(" + result + ")) {");
+
+  indent++;
+  line(result + " = " + emit(*expr.right) + ";");
+  indent--;
+  line("}");
+
+  return result;
+}
+
+static const char *operatorName(TokenType type) {
+  switch (type) {
+  case TokenType::PLUS:
+    return "PLUS";
+  case TokenType::MINUS:
+    return "MINUS";
+  case TokenType::STAR:
+    return "STAR";
+  case TokenType::SLASH:
+    return "SLASH";
+  case TokenType::GREATER:
+    return "GREATER";
+  case TokenType::GREATER_EQUAL:
+    return "GREATER_EQUAL";
+  case TokenType::LESS:
+    return "LESS";
+  case TokenType::LESS_EQUAL:
+    return "LESS_EQUAL";
+  case TokenType::EQUAL_EQUAL:
+    return "EQUAL_EQUAL";
+  case TokenType::BANG_EQUAL:
+    return "BANG_EQUAL";
+  default:
+    std::cerr << "No binary operator named for token type "
+              << static_cast<int>(type) << ".\n";
+    std::abort();
+  }
+}
+
+template <TokenType OP>
+std::string CppEmitter::operator()(BinaryOp<OP> &expr) {
+  std::string left = emit(*expr.left);
+  std::string right = emit(*expr.right);
+
+  return temp(std::string("AotRuntime::binary<TokenType::") +
+              operatorName(OP) + ">(" + token(expr.op) + ", " + left + ", " +
+              right + ")");
+}
+
+std::string CppEmitter::operator()(Call &expr) {
+  std::string callee = emit(*expr.callee);
+  std::string args = emitArgs(expr.args);
+
+  return temp("AotRuntime::call(interpreter, " + token(expr.paren) + ", " +
+              callee + ", " + args + ")");
+}
+
+std::string CppEmitter::operator()(Get &expr) {
+  std::string object = emit(*expr.object);
+  return temp("AotRuntime::get(" + token(expr.name) + ", " + object + ")");
+}
+
+std::string CppEmitter::operator()(Set &expr) {
+  std::string object = emit(*expr.object);
+  line("AotRuntime::checkFields(" + token(expr.name) + ", " + object + ");");
+
+  std::string value = emit(*expr.value);
+  line("AotRuntime::set(" + token(expr.name) + ", " + object + ", " + value +
+       ");");
+
+  return value;
+}
+
+std::string CppEmitter::operator()(Grouping &expr) {
+  return emit(*expr.expression);
+}
+
+std::string CppEmitter::operator()(Literal &expr) {
+  return temp(literal(expr.value));
+}
+
+std::string CppEmitter::operator()(Unary &expr) {
+  std::string right = emit(*expr.right);
+
+  if (expr.op.type == TokenType::MINUS)
+    return temp("AotRuntime::negate(" + token(expr.op) + ", " + right + ")");
+
+  return temp("!AotRuntime::truthy(" + right + ")");
+}
+
+std::string CppEmitter::operator()(Variable &expr) {
+  return load(expr.name, expr.id);
+}
+
+std::string CppEmitter::operator()(ListLiteral &expr) {
+  return temp("AotRuntime::list(" + emitArgs(expr.elements) + ")");
+}
+
+std::string CppEmitter::operator()(Index &expr) {
+  std::string object = emit(*expr.object);
+  std::string index = emit(*expr.index);
+
+  return temp("AotRuntime::index(" + token(expr.bracket) + ", " + object +
+              ", " + index + ")");
+}
+
+std::string CppEmitter::operator()(SetIndex &expr) {
+  std::string object = emit(*expr.object);
+  std::string index = emit(*expr.index);
+  line("AotRuntime::checkIndexed(" + token(expr.bracket) + ", " + object +
+       ", " + index + ");");
+
+  std::string value = emit(*expr.value);
+  line("AotRuntime::setIndex(" + token(expr.bracket) + ", " + object + ", " +
+       index + ", " + value + ");");
+
+  return value;
+}
+
+// Statements
+
+void CppEmitter::operator()(Block &stmt) {
+  line("{");
+  indent++;
+  beginScope(needsEnvironment(stmt.statements, nullptr));
+
+  for (std::shared_ptr<Stmt> &statement : stmt.statements) {
+    emit(*statement);
+  }
+
+  endScope();
+  indent--;
+  line("}");
+}
+
+void CppEmitter::operator()(Class &stmt) {
+  declare(&stmt, stmt.name);
+  initialize(stmt.name, "AotRuntime::klass(" + quote(stmt.name.lexeme) + ")");
+}
+
+void CppEmitter::operator()(Expression &stmt) { emit(*stmt.expr); }
+
+void CppEmitter::operator()(Func &stmt) {
+  // Declared before the body, which may call the function.
+  declare(&stmt, stmt.name);
+  std::string body = emitFunction(stmt);
+
+  initialize(stmt.name, "AotRuntime::function(" + quote(stmt.name.lexeme) +
+                            ", " + std::to_string(stmt.params.size()) + ", " +
+                            body + ", " + currentEnvironment() + ")");
+}
+
+void CppEmitter::operator()(If &stmt) {
+  std::string condition = emit(*stmt.condition);
+  line("if (AotRuntime::truthy(" + condition + ")) {");
+  indent++;
+  emit(*stmt.thenBranch);
+  indent--;
+
+  if (stmt.elseBranch != nullptr) {
+    line("} else {");
+    indent++;
+    emit(*stmt.elseBranch);
+    indent--;
+  }
+
+  line("}");
+}
+
+void CppEmitter::operator()(Print &stmt) {
+  line("AotRuntime::print(" + emit(*stmt.expr) + ");");
+}
+
+void CppEmitter::operator()(Return &stmt) {
+  if (stmt.value == nullptr) {
+    line("return LiteralObject{};");
+    return;
+  }
+
+  Call *call = std::get_if<Call>(stmt.value.get());
+
+  if (stmt.tailCall && call != nullptr) {
+    std::string callee = emit(*call->callee);
+    std::string args = emitArgs(call->args);
+    line("return AotRuntime::tailCall(interpreter, " + token(call->paren) +
+         ", " + callee + ", " + args + ");");
+    return;
+  }
+
+  line("return " + emit(*stmt.value) + ";");
+}
+
+void CppEmitter::operator()(Var &stmt) {
+  std::string value = stmt.initializer != nullptr ? emit(*stmt.initializer)
+                                                  : "LiteralObject{}";
+  declare(&stmt, stmt.name);
+  initialize(stmt.name, value);
+}
+
+void CppEmitter::operator()(While &stmt) {
+  line("while (true) {");
+  indent++;
+
+  std::string condition = emit(*stmt.condition);
+  line("if (!AotRuntime::truthy(" + condition + "))");
+  line("  break;");
+  emit(*stmt.body);
+
+  indent--;
+  line("}");
+}
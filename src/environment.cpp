@@ -1,21 +1,26 @@
 #include "environment.hpp"
 #include "lox_callable.hpp"
+#include "metrics.hpp"
 #include "runtime_error.hpp"
 #include "token.hpp"
 #include <iostream>
 #include <unordered_map>
 
-Environment::Environment() { enclosing = nullptr; }
+Environment::Environment() {
+  enclosing = nullptr;
+  Metrics::add(Metrics::ENVIRONMENTS);
+}
 
 Environment::Environment(std::shared_ptr<Environment> enclosing) {
   this->enclosing = enclosing;
+  Metrics::add(Metrics::ENVIRONMENTS);
 }
 
-void Environment::define(std::string name, LiteralObject value) {
-  values.insert({name, value});
+void Environment::define(const std::string &name, LiteralObject value) {
+  values.insert_or_assign(name, std::move(value));
 }
 
-void Environment::assign(Token name, LiteralObject value) {
+void Environment::assign(const Token &name, LiteralObject value) {
   if (values.count(name.lexeme)) {
     values[name.lexeme] = value;
     return;
@@ -27,11 +32,12 @@ void Environment::assign(Token name, LiteralObject value) {
   throw new RuntimeError(name, "Undefined variable '" + name.lexeme + "'.");
 }
 
-void Environment::assignAt(int distance, Token name, LiteralObject value) {
+void Environment::assignAt(int distance, const Token &name,
+                           LiteralObject value) {
   ancestor(distance)->values[name.lexeme] = value;
 }
 
-LiteralObject Environment::get(Token name) {
+LiteralObject Environment::get(const Token &name) {
   if (values.count(name.lexeme)) {
     return values[name.lexeme];
   }
@@ -43,7 +49,7 @@ LiteralObject Environment::get(Token name) {
   throw new RuntimeError(name, "Undefined variable '" + name.lexeme + "'.");
 }
 
-LiteralObject Environment::getAt(int distance, Token name) {
+LiteralObject Environment::getAt(int distance, const Token &name) {
   return ancestor(distance)->values[name.lexeme];
 }
 
@@ -56,3 +62,13 @@ Environment *Environment::ancestor(int distance) {
 
   return env;
 }
+
+void Environment::reset(std::shared_ptr<Environment> enclosing) {
+  this->enclosing = std::move(enclosing);
+
+  // Releases the values but keeps the entries, which the next activation
+  // redefines in place; clear() would free and reallocate every one.
+  for (auto &entry : values) {
+    entry.second = std::monostate{};
+  }
+}
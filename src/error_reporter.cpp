@@ -1,14 +1,25 @@
 #include "error_reporter.hpp"
 #include "lox_callable.hpp"
+#include "metrics.hpp"
+#include "output.hpp"
 #include "token.hpp"
 #include "token_type.hpp"
 #include <iostream>
 
+extern Output output;
+
+static thread_local size_t threadErrorCount = 0;
+
+size_t ErrorReporter::threadErrors() { return threadErrorCount; }
+
 void ErrorReporter::reportError(int line, std::string where,
                                 std::string message) {
+  std::lock_guard<std::mutex> lock(mutex);
+  output.flush();
   std::cout << "[line " << line << "] Error" << where << ": " << message
             << "\n";
   hadError = true;
+  threadErrorCount++;
 }
 
 void ErrorReporter::error(Token token, std::string message) {
@@ -20,7 +31,10 @@ void ErrorReporter::error(Token token, std::string message) {
 }
 
 void ErrorReporter::runtimeError(RuntimeError *error) {
+  std::lock_guard<std::mutex> lock(mutex);
+  output.flush();
   std::cout << error->message << "\n[line " << error->token.line << "]"
             << std::endl;
   hadRuntimeError = true;
+  Metrics::add(Metrics::RUNTIME_ERRORS);
 }
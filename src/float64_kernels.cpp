@@ -0,0 +1,283 @@
+#include "float64_kernels.hpp"
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS
+#endif
+
+// Scalar
+
+static void scalarAdd(const double *a, const double *b, double *out,
+                      size_t size) {
+  for (size_t i = 0; i < size; i++)
+    out[i] = a[i] + b[i];
+}
+
+static void scalarMul(const double *a, const double *b, double *out,
+                      size_t size) {
+  for (size_t i = 0; i < size; i++)
+    out[i] = a[i] * b[i];
+}
+
+static void scalarFma(const double *a, const double *b, const double *c,
+                      double *out, size_t size) {
+  for (size_t i = 0; i < size; i++)
+    out[i] = std::fma(a[i], b[i], c[i]);
+}
+
+static void scalarScale(const double *a, double factor, double *out,
+                        size_t size) {
+  for (size_t i = 0; i < size; i++)
+    out[i] = a[i] * factor;
+}
+
+static void scalarSqrt(const double *a, double *out, size_t size) {
+  for (size_t i = 0; i < size; i++)
+    out[i] = std::sqrt(a[i]);
+}
+
+static double scalarSum(const double *a, size_t size) {
+  double sum = 0;
+
+  for (size_t i = 0; i < size; i++)
+    sum += a[i];
+
+  return sum;
+}
+
+static double scalarDot(const double *a, const double *b, size_t size) {
+  double sum = 0;
+
+  for (size_t i = 0; i < size; i++)
+    sum += a[i] * b[i];
+
+  return sum;
+}
+
+// min and max order -0 below +0 and return NaN if any element is one, so
+// that, unlike std::min and std::max, the result doesn't depend on the
+// order elements are compared in, and both builds agree.
+static double orderedMin(double a, double b) {
+  if (std::isnan(a) || std::isnan(b))
+    return std::numeric_limits<double>::quiet_NaN();
+
+  if (a == b)
+    return std::signbit(a) ? a : b;
+
+  return a < b ? a : b;
+}
+
+static double orderedMax(double a, double b) {
+  if (std::isnan(a) || std::isnan(b))
+    return std::numeric_limits<double>::quiet_NaN();
+
+  if (a == b)
+    return std::signbit(a) ? b : a;
+
+  return a > b ? a : b;
+}
+
+static double scalarMin(const double *a, size_t size) {
+  double min = a[0];
+
+  for (size_t i = 1; i < size; i++)
+    min = orderedMin(min, a[i]);
+
+  return min;
+}
+
+static double scalarMax(const double *a, size_t size) {
+  double max = a[0];
+
+  for (size_t i = 1; i < size; i++)
+    max = orderedMax(max, a[i]);
+
+  return max;
+}
+
+// AVX2 and FMA
+//
+// Four doubles per register. The loops leave the last size % 4 elements (or
+// % 16 for the reductions) to the scalar code. Reductions keep four
+// accumulators so consecutive additions don't wait on each other.
+
+#ifdef HAVE_AVX2_KERNELS
+
+#define AVX2 __attribute__((target("avx2,fma")))
+
+AVX2 static void avx2Add(const double *a, const double *b, double *out,
+                         size_t size) {
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i),
+                                            _mm256_loadu_pd(b + i)));
+
+  scalarAdd(a + i, b + i, out + i, size - i);
+}
+
+AVX2 static void avx2Mul(const double *a, const double *b, double *out,
+                         size_t size) {
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i),
+                                            _mm256_loadu_pd(b + i)));
+
+  scalarMul(a + i, b + i, out + i, size - i);
+}
+
+AVX2 static void avx2Fma(const double *a, const double *b, const double *c,
+                         double *out, size_t size) {
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_fmadd_pd(_mm256_loadu_pd(a + i),
+                                              _mm256_loadu_pd(b + i),
+                                              _mm256_loadu_pd(c + i)));
+
+  scalarFma(a + i, b + i, c + i, out + i, size - i);
+}
+
+AVX2 static void avx2Scale(const double *a, double factor, double *out,
+                           size_t size) {
+  __m256d factors = _mm256_set1_pd(factor);
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factors));
+
+  scalarScale(a + i, factor, out + i, size - i);
+}
+
+AVX2 static void avx2Sqrt(const double *a, double *out, size_t size) {
+  size_t i = 0;
+
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(a + i)));
+
+  scalarSqrt(a + i, out + i, size - i);
+}
+
+AVX2 static double horizontalSum(__m256d v) {
+  __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v),
+                            _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+AVX2 static double avx2Sum(const double *a, size_t size) {
+  __m256d sums[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(),
+                     _mm256_setzero_pd(), _mm256_setzero_pd()};
+  size_t i = 0;
+
+  for (; i + 16 <= size; i += 16) {
+    for (int j = 0; j < 4; j++)
+      sums[j] = _mm256_add_pd(sums[j], _mm256_loadu_pd(a + i + 4 * j));
+  }
+
+  __m256d total = _mm256_add_pd(_mm256_add_pd(sums[0], sums[1]),
+                                _mm256_add_pd(sums[2], sums[3]));
+  return horizontalSum(total) + scalarSum(a + i, size - i);
+}
+
+AVX2 static double avx2Dot(const double *a, const double *b, size_t size) {
+  __m256d sums[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(),
+                     _mm256_setzero_pd(), _mm256_setzero_pd()};
+  size_t i = 0;
+
+  for (; i + 16 <= size; i += 16) {
+    for (int j = 0; j < 4; j++)
+      sums[j] = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4 * j),
+                                _mm256_loadu_pd(b + i + 4 * j), sums[j]);
+  }
+
+  __m256d total = _mm256_add_pd(_mm256_add_pd(sums[0], sums[1]),
+                                _mm256_add_pd(sums[2], sums[3]));
+  return horizontalSum(total) + scalarDot(a + i, b + i, size - i);
+}
+
+// vminpd and vmaxpd return their second operand when either is NaN or
+// the two are equal. NaNs are tracked in a mask of their own instead, and
+// equal lanes, which differ at most in the sign of a zero, take the OR of
+// both for min (-0) and the AND for max (+0), as orderedMin and orderedMax
+// do.
+AVX2 static double avx2Min(const double *a, size_t size) {
+  if (size < 4)
+    return scalarMin(a, size);
+
+  __m256d min = _mm256_loadu_pd(a);
+  __m256d nans = _mm256_cmp_pd(min, min, _CMP_UNORD_Q);
+  size_t i = 4;
+
+  for (; i + 4 <= size; i += 4) {
+    __m256d next = _mm256_loadu_pd(a + i);
+    nans = _mm256_or_pd(nans, _mm256_cmp_pd(next, next, _CMP_UNORD_Q));
+    min = _mm256_blendv_pd(_mm256_min_pd(next, min), _mm256_or_pd(next, min),
+                           _mm256_cmp_pd(next, min, _CMP_EQ_OQ));
+  }
+
+  if (_mm256_movemask_pd(nans) != 0)
+    return std::numeric_limits<double>::quiet_NaN();
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, min);
+  double result = scalarMin(lanes, 4);
+
+  return i < size ? orderedMin(result, scalarMin(a + i, size - i)) : result;
+}
+
+AVX2 static double avx2Max(const double *a, size_t size) {
+  if (size < 4)
+    return scalarMax(a, size);
+
+  __m256d max = _mm256_loadu_pd(a);
+  __m256d nans = _mm256_cmp_pd(max, max, _CMP_UNORD_Q);
+  size_t i = 4;
+
+  for (; i + 4 <= size; i += 4) {
+    __m256d next = _mm256_loadu_pd(a + i);
+    nans = _mm256_or_pd(nans, _mm256_cmp_pd(next, next, _CMP_UNORD_Q));
+    max = _mm256_blendv_pd(_mm256_max_pd(next, max),
+                           _mm256_and_pd(next, max),
+                           _mm256_cmp_pd(next, max, _CMP_EQ_OQ));
+  }
+
+  if (_mm256_movemask_pd(nans) != 0)
+    return std::numeric_limits<double>::quiet_NaN();
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, max);
+  double result = scalarMax(lanes, 4);
+
+  return i < size ? orderedMax(result, scalarMax(a + i, size - i)) : result;
+}
+
+#undef AVX2
+
+#endif
+
+static const Float64Kernels scalarKernels{
+    scalarAdd,  scalarMul, scalarFma, scalarScale, scalarSqrt,
+    scalarSum,  scalarDot, scalarMin, scalarMax};
+
+#ifdef HAVE_AVX2_KERNELS
+static const Float64Kernels avx2Kernels{avx2Add,   avx2Mul, avx2Fma,
+                                        avx2Scale, avx2Sqrt, avx2Sum,
+                                        avx2Dot,   avx2Min, avx2Max};
+#endif
+
+const Float64Kernels &float64Kernels() {
+#ifdef HAVE_AVX2_KERNELS
+  static const bool avx2 =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+
+  if (avx2)
+    return avx2Kernels;
+#endif
+
+  return scalarKernels;
+}
+
+const Float64Kernels &scalarFloat64Kernels() { return scalarKernels; }
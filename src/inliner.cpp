@@ -0,0 +1,384 @@
+#include "inliner.hpp"
+#include "options.hpp"
+#include <memory>
+#include <variant>
+
+extern Options options;
+
+Inliner::Inliner(Interpreter &interpreter) : interpreter(interpreter) {}
+
+std::string Inliner::name() const { return "inline"; }
+
+void Inliner::run(std::vector<std::shared_ptr<Stmt>> &statements) {
+  analyze(statements);
+
+  // Call sites were recorded after their arguments and in program order, so
+  // calls nested in arguments or in a helper's own body are inlined before
+  // the calls that would copy them.
+  for (const CallSite &site : callSites) {
+    if (inlineCall(site)) {
+      inlinedCalls++;
+      inlinedFunctions.insert(site.target);
+    }
+  }
+}
+
+void Inliner::report(std::ostream &out) const {
+  out << "inline: " << inlinedCalls << " call sites inlined from "
+      << inlinedFunctions.size() << " functions\n";
+}
+
+// Inlining
+
+bool Inliner::isParam(const Variable &variable) const {
+  // The body of a single-return function has no blocks or declarations, so
+  // anything in its own scope is a parameter.
+  if (!variable.id.has_value())
+    return false;
+
+  auto local = interpreter.locals.find(variable.id.value());
+  return local != interpreter.locals.end() && local->second == 0;
+}
+
+size_t Inliner::bodySize(const std::shared_ptr<Expr> &expr) const {
+  if (std::holds_alternative<Literal>(*expr))
+    return 1;
+
+  if (const Variable *variable = std::get_if<Variable>(expr.get()))
+    return isParam(*variable) ? 1 : 0;
+
+  size_t children = 0;
+
+  if (const Grouping *grouping = std::get_if<Grouping>(expr.get())) {
+    children = bodySize(grouping->expression);
+  } else if (const Unary *unary = std::get_if<Unary>(expr.get())) {
+    children = bodySize(unary->right);
+  } else if (const Get *get = std::get_if<Get>(expr.get())) {
+    children = bodySize(get->object);
+  } else if (const Logical *logical = std::get_if<Logical>(expr.get())) {
+    size_t left = bodySize(logical->left);
+    size_t right = bodySize(logical->right);
+    children = left == 0 || right == 0 ? 0 : left + right;
+  } else if (Binary *binary = std::visit(AsBinary{}, *expr)) {
+    size_t left = bodySize(binary->left);
+    size_t right = bodySize(binary->right);
+    children = left == 0 || right == 0 ? 0 : left + right;
+  }
+
+  return children == 0 ? 0 : children + 1;
+}
+
+size_t Inliner::uses(const std::shared_ptr<Expr> &expr,
+                     const std::string &name) {
+  if (const Variable *variable = std::get_if<Variable>(expr.get()))
+    return variable->name.lexeme == name ? 1 : 0;
+
+  if (const Grouping *grouping = std::get_if<Grouping>(expr.get()))
+    return uses(grouping->expression, name);
+
+  if (const Unary *unary = std::get_if<Unary>(expr.get()))
+    return uses(unary->right, name);
+
+  if (const Get *get = std::get_if<Get>(expr.get()))
+    return uses(get->object, name);
+
+  if (const Logical *logical = std::get_if<Logical>(expr.get()))
+    return uses(logical->left, name) + uses(logical->right, name);
+
+  if (Binary *binary = std::visit(AsBinary{}, *expr))
+    return uses(binary->left, name) + uses(binary->right, name);
+
+  return 0;
+}
+
+const Variable *Inliner::firstLeaf(const std::shared_ptr<Expr> &expr) {
+  if (const Grouping *grouping = std::get_if<Grouping>(expr.get()))
+    return firstLeaf(grouping->expression);
+
+  if (const Unary *unary = std::get_if<Unary>(expr.get()))
+    return firstLeaf(unary->right);
+
+  if (const Get *get = std::get_if<Get>(expr.get()))
+    return firstLeaf(get->object);
+
+  if (const Logical *logical = std::get_if<Logical>(expr.get()))
+    return firstLeaf(logical->left);
+
+  if (Binary *binary = std::visit(AsBinary{}, *expr))
+    return firstLeaf(binary->left);
+
+  return std::get_if<Variable>(expr.get());
+}
+
+bool Inliner::inlineCall(const CallSite &site) {
+  Call &call = std::get<Call>(**site.slot);
+  Func &func = *site.target;
+
+  if (call.args.size() != func.params.size() ||
+      assignedNames.count(func.name.lexeme))
+    return false;
+
+  if (site.global &&
+      (options.interactive || globalDecls[func.name.lexeme] != 1))
+    return false;
+
+  std::shared_ptr<Expr> &body = std::get<Return>(*func.body[0]).value;
+  size_t size = bodySize(body);
+
+  if (size == 0 || size > options.inlineThreshold)
+    return false;
+
+  std::unordered_map<std::string, std::shared_ptr<Expr>> args{};
+  bool sawComplex = false;
+
+  for (size_t i = 0; i < call.args.size(); i++) {
+    const std::string &param = func.params[i].lexeme;
+    std::shared_ptr<Expr> &arg = call.args[i];
+    size_t paramUses = uses(body, param);
+
+    if (std::holds_alternative<Literal>(*arg)) {
+      args[param] = arg;
+      continue;
+    }
+
+    // Reading a variable has no side effects, but an argument evaluated
+    // earlier might assign to it, and an undefined global must still fail.
+    if (Variable *variable = std::get_if<Variable>(arg.get())) {
+      bool isLocal = variable->id.has_value() &&
+                     interpreter.locals.count(variable->id.value());
+
+      if (!sawComplex && (isLocal || paramUses > 0)) {
+        args[param] = arg;
+        continue;
+      }
+    }
+
+    // Anything else has to be evaluated exactly once, before the body does
+    // anything else, and after nothing but literals.
+    bool firstInBody = firstLeaf(body) != nullptr &&
+                       firstLeaf(body)->name.lexeme == param;
+
+    if (sawComplex || paramUses != 1 || !firstInBody)
+      return false;
+
+    for (size_t j = 0; j < i; j++) {
+      if (!std::holds_alternative<Literal>(*call.args[j]))
+        return false;
+    }
+
+    sawComplex = true;
+    args[param] = arg;
+  }
+
+  *site.slot = substitute(body, args);
+  return true;
+}
+
+std::shared_ptr<Expr> Inliner::substitute(
+    const std::shared_ptr<Expr> &expr,
+    std::unordered_map<std::string, std::shared_ptr<Expr>> &args) {
+  if (Variable *variable = std::get_if<Variable>(expr.get()))
+    return std::make_shared<Expr>(*args[variable->name.lexeme]);
+
+  if (Grouping *grouping = std::get_if<Grouping>(expr.get())) {
+    Grouping copy = *grouping;
+    copy.expression = substitute(grouping->expression, args);
+    return std::make_shared<Expr>(copy);
+  }
+
+  if (Unary *unary = std::get_if<Unary>(expr.get())) {
+    Unary copy = *unary;
+    copy.right = substitute(unary->right, args);
+    return std::make_shared<Expr>(copy);
+  }
+
+  if (Get *get = std::get_if<Get>(expr.get())) {
+    Get copy = *get;
+    copy.object = substitute(get->object, args);
+    return std::make_shared<Expr>(copy);
+  }
+
+  if (Logical *logical = std::get_if<Logical>(expr.get())) {
+    Logical copy = *logical;
+    copy.left = substitute(logical->left, args);
+    copy.right = substitute(logical->right, args);
+    return std::make_shared<Expr>(copy);
+  }
+
+  if (std::visit(AsBinary{}, *expr) != nullptr) {
+    std::shared_ptr<Expr> copy = std::make_shared<Expr>(*expr);
+    Binary *binary = std::visit(AsBinary{}, *copy);
+    binary->left = substitute(binary->left, args);
+    binary->right = substitute(binary->right, args);
+    return copy;
+  }
+
+  return std::make_shared<Expr>(*expr);
+}
+
+// Analysis
+
+void Inliner::declare(const std::string &name, Func *func) {
+  if (scopes.empty()) {
+    globalDecls[name]++;
+
+    if (func != nullptr)
+      globals[name] = func;
+    return;
+  }
+
+  scopes.back()[name] = func;
+}
+
+Func *Inliner::resolve(const Variable &callee, bool &global) {
+  if (!callee.id.has_value())
+    return nullptr;
+
+  auto local = interpreter.locals.find(callee.id.value());
+  global = local == interpreter.locals.end();
+
+  if (global) {
+    auto global = globals.find(callee.name.lexeme);
+    return global == globals.end() ? nullptr : global->second;
+  }
+
+  int index = scopes.size() - 1 - local->second;
+  if (index < 0 || !scopes[index].count(callee.name.lexeme))
+    return nullptr;
+
+  return scopes[index][callee.name.lexeme];
+}
+
+void Inliner::operator()(Block &stmt) {
+  scopes.push_back({});
+  analyze(stmt.statements);
+  scopes.pop_back();
+}
+
+void Inliner::operator()(Class &stmt) { declare(stmt.name.lexeme, nullptr); }
+
+void Inliner::operator()(Expression &stmt) { analyze(stmt.expr); }
+
+void Inliner::operator()(Func &stmt) {
+  bool singleReturn =
+      stmt.body.size() == 1 && std::holds_alternative<Return>(*stmt.body[0]) &&
+      std::get<Return>(*stmt.body[0]).value != nullptr;
+
+  declare(stmt.name.lexeme, singleReturn ? &stmt : nullptr);
+
+  scopes.push_back({});
+
+  for (Token &param : stmt.params) {
+    declare(param.lexeme, nullptr);
+  }
+
+  analyze(stmt.body);
+
+  scopes.pop_back();
+}
+
+void Inliner::operator()(If &stmt) {
+  analyze(stmt.condition);
+  analyze(stmt.thenBranch);
+
+  if (stmt.elseBranch != nullptr)
+    analyze(stmt.elseBranch);
+}
+
+void Inliner::operator()(Print &stmt) { analyze(stmt.expr); }
+
+void Inliner::operator()(Return &stmt) {
+  if (stmt.value != nullptr)
+    analyze(stmt.value);
+}
+
+void Inliner::operator()(Var &stmt) {
+  declare(stmt.name.lexeme, nullptr);
+
+  if (stmt.initializer != nullptr)
+    analyze(stmt.initializer);
+}
+
+void Inliner::operator()(While &stmt) {
+  analyze(stmt.condition);
+  analyze(stmt.body);
+}
+
+void Inliner::operator()(Assign &expr) {
+  assignedNames.insert(expr.name.lexeme);
+  analyze(expr.value);
+}
+
+void Inliner::operator()(Logical &expr) {
+  analyze(expr.left);
+  analyze(expr.right);
+}
+
+void Inliner::operator()(Binary &expr) {
+  analyze(expr.left);
+  analyze(expr.right);
+}
+
+void Inliner::operator()(Call &expr) {
+  std::shared_ptr<Expr> *slot = currentSlot;
+
+  analyze(expr.callee);
+
+  for (std::shared_ptr<Expr> &arg : expr.args) {
+    analyze(arg);
+  }
+
+  if (Variable *callee = std::get_if<Variable>(expr.callee.get())) {
+    bool global = false;
+
+    if (Func *target = resolve(*callee, global))
+      callSites.push_back(CallSite{slot, target, global});
+  }
+}
+
+void Inliner::operator()(Get &expr) { analyze(expr.object); }
+
+void Inliner::operator()(Set &expr) {
+  analyze(expr.object);
+  analyze(expr.value);
+}
+
+void Inliner::operator()(Grouping &expr) { analyze(expr.expression); }
+
+void Inliner::operator()(Literal &expr) {}
+
+void Inliner::operator()(Unary &expr) { analyze(expr.right); }
+
+void Inliner::operator()(Variable &expr) {}
+
+void Inliner::operator()(ListLiteral &expr) {
+  for (std::shared_ptr<Expr> &element : expr.elements) {
+    analyze(element);
+  }
+}
+
+void Inliner::operator()(Index &expr) {
+  analyze(expr.object);
+  analyze(expr.index);
+}
+
+void Inliner::operator()(SetIndex &expr) {
+  analyze(expr.object);
+  analyze(expr.index);
+  analyze(expr.value);
+}
+
+void Inliner::analyze(std::vector<std::shared_ptr<Stmt>> &statements) {
+  for (std::shared_ptr<Stmt> &stmt : statements) {
+    analyze(stmt);
+  }
+}
+
+void Inliner::analyze(std::shared_ptr<Stmt> &statement) {
+  std::visit(*this, *statement);
+}
+
+void Inliner::analyze(std::shared_ptr<Expr> &expr) {
+  currentSlot = &expr;
+  std::visit(*this, *expr);
+}
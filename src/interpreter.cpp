@@ -1,36 +1,118 @@
 #include "interpreter.hpp"
 #include "error_reporter.hpp"
 #include "expr.hpp"
-#include "func_return.hpp"
 #include "lox_callable.hpp"
+#include "lox_csv.hpp"
+#include "lox_float64_array.hpp"
+#include "lox_json.hpp"
+#include "lox_list.hpp"
+#include "lox_map.hpp"
+#include "lox_mapping.hpp"
+#include "lox_reader.hpp"
+#include "lox_string.hpp"
+#include "lox_strings.hpp"
+#include "metrics.hpp"
+#include "options.hpp"
+#include "output.hpp"
 #include "runtime_error.hpp"
 #include "stmt.hpp"
 #include "token.hpp"
 #include "token_type.hpp"
+#include <cmath>
 #include <exception>
 #include <iostream>
 #include <memory>
 #include <variant>
 
 extern ErrorReporter errorReporter;
+extern Options options;
+extern Output output;
 
-void checkNumberOperand(Token op, LiteralObject obj) {
+void checkNumberOperand(const Token &op, const LiteralObject &obj) {
   if (std::holds_alternative<double>(obj))
     return;
   throw new RuntimeError(op, "Operand must be a number.");
 }
 
-void checkNumberOperands(Token op, LiteralObject obj1, LiteralObject obj2) {
+void checkNumberOperands(const Token &op, const LiteralObject &obj1,
+                         const LiteralObject &obj2) {
   if (std::holds_alternative<double>(obj1) &&
       std::holds_alternative<double>(obj2))
     return;
   throw new RuntimeError(op, "Operands must be numbers.");
 }
 
+size_t checkIndex(Token bracket, LiteralObject index, size_t size) {
+  if (!std::holds_alternative<double>(index))
+    throw new RuntimeError(bracket, "Index must be a number.");
+
+  double value = std::get<double>(index);
+
+  if (value != std::floor(value))
+    throw new RuntimeError(bracket, "Index must be an integer.");
+
+  if (value < 0 || value >= size)
+    throw new RuntimeError(bracket, "Index out of bounds.");
+
+  return static_cast<size_t>(value);
+}
+
+void checkFloat64Element(Token bracket, LiteralObject value) {
+  if (!std::holds_alternative<double>(value))
+    throw new RuntimeError(bracket, "Float64Array elements must be numbers.");
+}
+
+void checkMapKey(Token bracket, LiteralObject key) {
+  if (!LoxMap::isValidKey(key))
+    throw new RuntimeError(bracket,
+                           "Map keys must be numbers, strings or booleans.");
+}
+
 Interpreter::Interpreter() {
   std::shared_ptr<ClockFunc> clockFunc = std::make_shared<ClockFunc>();
 
   globals->define("clock", clockFunc);
+  globals->define("len", std::make_shared<LenFunc>());
+  globals->define("push", std::make_shared<PushFunc>());
+  globals->define("pop", std::make_shared<PopFunc>());
+  globals->define("Map", std::make_shared<MapFunc>());
+  globals->define("has", std::make_shared<HasFunc>());
+  globals->define("remove", std::make_shared<RemoveFunc>());
+  globals->define("keys", std::make_shared<KeysFunc>());
+  globals->define("values", std::make_shared<ValuesFunc>());
+  globals->define("open", std::make_shared<OpenFunc>());
+  globals->define("stdin", std::make_shared<StdinFunc>());
+  globals->define("readLine", std::make_shared<ReadLineFunc>());
+  globals->define("readChunk", std::make_shared<ReadChunkFunc>());
+  globals->define("close", std::make_shared<CloseFunc>());
+  globals->define("mmapFile", std::make_shared<MmapFileFunc>());
+  globals->define("slice", std::make_shared<SliceFunc>());
+  globals->define("find", std::make_shared<FindFunc>());
+  globals->define("byteAt", std::make_shared<ByteAtFunc>());
+  globals->define("text", std::make_shared<TextFunc>());
+  globals->define("advise", std::make_shared<AdviseFunc>());
+  globals->define("jsonParse", std::make_shared<JsonParseFunc>());
+  globals->define("jsonStringify", std::make_shared<JsonStringifyFunc>());
+  globals->define("csvRow", std::make_shared<CsvRowFunc>());
+  globals->define("csvEach", std::make_shared<CsvEachFunc>());
+  globals->define("substr", std::make_shared<SubstrFunc>());
+  globals->define("indexOf", std::make_shared<IndexOfFunc>());
+  globals->define("split", std::make_shared<SplitFunc>());
+  globals->define("replace", std::make_shared<ReplaceFunc>());
+  globals->define("toUpper", std::make_shared<ToUpperFunc>());
+  globals->define("toLower", std::make_shared<ToLowerFunc>());
+  globals->define("trim", std::make_shared<TrimFunc>());
+  globals->define("startsWith", std::make_shared<StartsWithFunc>());
+  globals->define("Float64Array", std::make_shared<Float64ArrayFunc>());
+  globals->define("add", std::make_shared<AddFunc>());
+  globals->define("mul", std::make_shared<MulFunc>());
+  globals->define("fma", std::make_shared<FmaFunc>());
+  globals->define("scale", std::make_shared<ScaleFunc>());
+  globals->define("sqrt", std::make_shared<SqrtFunc>());
+  globals->define("sum", std::make_shared<SumFunc>());
+  globals->define("dot", std::make_shared<DotFunc>());
+  globals->define("min", std::make_shared<MinFunc>());
+  globals->define("max", std::make_shared<MaxFunc>());
 }
 
 LiteralObject Interpreter::operator()(Assign &assign) {
@@ -59,6 +141,9 @@ LiteralObject Interpreter::operator()(Unary &unary) {
 
   switch (unary.op.type) {
   case TokenType::MINUS:
+    if (unary.operandType == StaticType::NUMBER)
+      return -*std::get_if<double>(&right);
+
     checkNumberOperand(unary.op, right);
     return -std::get<double>(right);
   case TokenType::BANG:
@@ -70,70 +155,209 @@ LiteralObject Interpreter::operator()(Unary &unary) {
   return std::monostate{};
 }
 
-LiteralObject Interpreter::operator()(Binary &binary) {
-  LiteralObject left = evaluate(*binary.left);
-  LiteralObject right = evaluate(*binary.right);
+template <TokenType OP> LiteralObject numberOp(double a, double b) {
+  if constexpr (OP == TokenType::PLUS)
+    return a + b;
+  else if constexpr (OP == TokenType::MINUS)
+    return a - b;
+  else if constexpr (OP == TokenType::STAR)
+    return a * b;
+  else if constexpr (OP == TokenType::SLASH)
+    return a / b;
+  else if constexpr (OP == TokenType::GREATER)
+    return a > b;
+  else if constexpr (OP == TokenType::GREATER_EQUAL)
+    return a >= b;
+  else if constexpr (OP == TokenType::LESS)
+    return a < b;
+  else if constexpr (OP == TokenType::LESS_EQUAL)
+    return a <= b;
+  else if constexpr (OP == TokenType::EQUAL_EQUAL)
+    return a == b;
+  else
+    return a != b;
+}
 
-  switch (binary.op.type) {
-  case TokenType::EQUAL_EQUAL:
-    return left == right;
+template <TokenType OP>
+LiteralObject Interpreter::genericOp(const Token &op, const LiteralObject &left,
+                                     const LiteralObject &right) {
+  if constexpr (OP == TokenType::EQUAL_EQUAL) {
+    return isEqual(left, right);
+  } else if constexpr (OP == TokenType::BANG_EQUAL) {
+    return !isEqual(left, right);
+  } else if constexpr (OP == TokenType::PLUS) {
+    if (std::holds_alternative<double>(left) &&
+        std::holds_alternative<double>(right))
+      return std::get<double>(left) + std::get<double>(right);
 
-  case TokenType::BANG_EQUAL:
-    return left != right;
+    if (std::holds_alternative<std::shared_ptr<LoxString>>(left) &&
+        std::holds_alternative<std::shared_ptr<LoxString>>(right))
+      return LoxString::concat(std::get<std::shared_ptr<LoxString>>(left),
+                               std::get<std::shared_ptr<LoxString>>(right));
 
-  case TokenType::GREATER:
-    checkNumberOperands(binary.op, left, right);
-    return std::get<double>(left) > std::get<double>(right);
+    throw new RuntimeError(op, "Operands must be two numbers or two strings.");
+  } else {
+    checkNumberOperands(op, left, right);
+    return numberOp<OP>(std::get<double>(left), std::get<double>(right));
+  }
+}
 
-  case TokenType::LESS:
-    checkNumberOperands(binary.op, left, right);
-    return std::get<double>(left) < std::get<double>(right);
+// Quickening
+//
+// A binary node's first evaluation looks at its operand types and
+// specializes the node for them: two numbers, or two strings for '+'. The
+// specialized path only guards on the operand types; on a miss the node is
+// rewritten to GENERIC for good and the operation is redone generically.
+
+void quicken(Binary &binary, const LiteralObject &left,
+             const LiteralObject &right) {
+  if (std::holds_alternative<double>(left) &&
+      std::holds_alternative<double>(right)) {
+    binary.specialization = Specialization::NUMBER;
+  } else if (binary.op.type == TokenType::PLUS &&
+             std::holds_alternative<std::shared_ptr<LoxString>>(left) &&
+             std::holds_alternative<std::shared_ptr<LoxString>>(right)) {
+    binary.specialization = Specialization::STRING;
+  } else {
+    binary.specialization = Specialization::GENERIC;
+  }
 
-  case TokenType::GREATER_EQUAL:
-    checkNumberOperands(binary.op, left, right);
-    return std::get<double>(left) >= std::get<double>(right);
+  if (options.quickenStats)
+    Interpreter::quickenedNodes.push_back(&binary);
+}
 
-  case TokenType::LESS_EQUAL:
-    checkNumberOperands(binary.op, left, right);
-    return std::get<double>(left) <= std::get<double>(right);
+void deoptimize(Binary &binary) {
+  binary.specialization = Specialization::GENERIC;
+  binary.deopts++;
+}
 
-  case TokenType::MINUS:
-    checkNumberOperands(binary.op, left, right);
-    return std::get<double>(left) - std::get<double>(right);
+std::string specializationName(const Binary &binary) {
+  static const std::unordered_map<TokenType, std::string> opNames{
+      {TokenType::PLUS, "add"},
+      {TokenType::MINUS, "sub"},
+      {TokenType::STAR, "mul"},
+      {TokenType::SLASH, "div"},
+      {TokenType::GREATER, "greater"},
+      {TokenType::GREATER_EQUAL, "greater-equal"},
+      {TokenType::LESS, "less"},
+      {TokenType::LESS_EQUAL, "less-equal"},
+      {TokenType::EQUAL_EQUAL, "equal"},
+      {TokenType::BANG_EQUAL, "not-equal"}};
+
+  switch (binary.specialization) {
+  case Specialization::NUMBER:
+    return "number-" + opNames.at(binary.op.type);
+  case Specialization::STRING:
+    return "string-concat";
+  case Specialization::GENERIC:
+    return "generic";
+  default:
+    return "unexecuted";
+  }
+}
 
-  case TokenType::PLUS:
-    if (std::holds_alternative<double>(left) &&
-        std::holds_alternative<double>(right))
-      return std::get<double>(left) + std::get<double>(right);
+std::vector<Binary *> Interpreter::quickenedNodes{};
 
-    if (std::holds_alternative<std::string>(left) &&
-        std::holds_alternative<std::string>(right))
-      return std::get<std::string>(left) + std::get<std::string>(right);
+void Interpreter::reportQuickening(std::ostream &out) {
+  for (Binary *binary : quickenedNodes) {
+    out << "[line " << binary->op.line << "] '" << binary->op.lexeme
+        << "' " << specializationName(*binary) << ": " << binary->hits
+        << " specialized hits, " << binary->deopts << " deopts\n";
+  }
 
-    throw new RuntimeError(binary.op,
-                           "Operands must be two numbers or two strings.");
+  quickenedNodes.clear();
+}
 
-  case TokenType::STAR:
-    checkNumberOperands(binary.op, left, right);
-    return std::get<double>(left) * std::get<double>(right);
+template <TokenType OP>
+LiteralObject Interpreter::operator()(BinaryOp<OP> &binary) {
+  LiteralObject left = evaluate(*binary.left);
+  LiteralObject right = evaluate(*binary.right);
 
-  case TokenType::SLASH:
-    checkNumberOperands(binary.op, left, right);
-    return std::get<double>(left) / std::get<double>(right);
+  // Operand types proven by TypeInference need no checks at all.
+  if (binary.operandType == StaticType::NUMBER)
+    return numberOp<OP>(*std::get_if<double>(&left),
+                        *std::get_if<double>(&right));
 
-  default:
+  if constexpr (OP == TokenType::PLUS) {
+    if (binary.operandType == StaticType::STRING)
+      return LoxString::concat(
+          *std::get_if<std::shared_ptr<LoxString>>(&left),
+          *std::get_if<std::shared_ptr<LoxString>>(&right));
+  }
+
+  switch (binary.specialization) {
+  case Specialization::NUMBER: {
+    const double *a = std::get_if<double>(&left);
+    const double *b = std::get_if<double>(&right);
+
+    if (a != nullptr && b != nullptr) {
+      binary.hits++;
+      return numberOp<OP>(*a, *b);
+    }
+
+    deoptimize(binary);
     break;
   }
 
-  return std::monostate{};
+  case Specialization::STRING:
+    if constexpr (OP == TokenType::PLUS) {
+      const std::shared_ptr<LoxString> *a =
+          std::get_if<std::shared_ptr<LoxString>>(&left);
+      const std::shared_ptr<LoxString> *b =
+          std::get_if<std::shared_ptr<LoxString>>(&right);
+
+      if (a != nullptr && b != nullptr) {
+        binary.hits++;
+        return LoxString::concat(*a, *b);
+      }
+    }
+
+    deoptimize(binary);
+    break;
+
+  case Specialization::UNEXECUTED:
+    quicken(binary, left, right);
+    break;
+
+  case Specialization::GENERIC:
+    break;
+  }
+
+  return genericOp<OP>(binary.op, left, right);
 }
 
-LiteralObject Interpreter::operator()(Call &expr) {
+template LiteralObject Interpreter::operator()(Add &);
+template LiteralObject Interpreter::operator()(Subtract &);
+template LiteralObject Interpreter::operator()(Multiply &);
+template LiteralObject Interpreter::operator()(Divide &);
+template LiteralObject Interpreter::operator()(Greater &);
+template LiteralObject Interpreter::operator()(GreaterEqual &);
+template LiteralObject Interpreter::operator()(Less &);
+template LiteralObject Interpreter::operator()(LessEqual &);
+template LiteralObject Interpreter::operator()(Equal &);
+template LiteralObject Interpreter::operator()(NotEqual &);
+
+#define INSTANTIATE_GENERIC_OP(OP)                                             \
+  template LiteralObject Interpreter::genericOp<TokenType::OP>(                \
+      const Token &, const LiteralObject &, const LiteralObject &);
+
+INSTANTIATE_GENERIC_OP(PLUS)
+INSTANTIATE_GENERIC_OP(MINUS)
+INSTANTIATE_GENERIC_OP(STAR)
+INSTANTIATE_GENERIC_OP(SLASH)
+INSTANTIATE_GENERIC_OP(GREATER)
+INSTANTIATE_GENERIC_OP(GREATER_EQUAL)
+INSTANTIATE_GENERIC_OP(LESS)
+INSTANTIATE_GENERIC_OP(LESS_EQUAL)
+INSTANTIATE_GENERIC_OP(EQUAL_EQUAL)
+INSTANTIATE_GENERIC_OP(BANG_EQUAL)
+
+std::shared_ptr<LoxCallable>
+Interpreter::evaluateCall(Call &expr, std::vector<LiteralObject> &args) {
+  Metrics::add(Metrics::CALLS);
   LiteralObject callee = evaluate(*expr.callee);
 
-  std::vector<LiteralObject> args{};
-
-  for (std::shared_ptr<Expr> arg : expr.args) {
+  for (std::shared_ptr<Expr> &arg : expr.args) {
     args.push_back(evaluate(*arg));
   }
 
@@ -150,15 +374,18 @@ LiteralObject Interpreter::operator()(Call &expr) {
                         " args, got " + std::to_string(args.size()) + ".");
   }
 
-  LiteralObject retObj = std::monostate{};
+  return function;
+}
+
+LiteralObject Interpreter::operator()(Call &expr) {
+  std::vector<LiteralObject> args{};
+  std::shared_ptr<LoxCallable> function = evaluateCall(expr, args);
 
   try {
-    retObj = function->call(*this, args);
-  } catch (FuncReturn *retVal) {
-    return retVal->value;
+    return function->call(*this, std::move(args));
+  } catch (NativeError *error) {
+    throw new RuntimeError(expr.paren, error->message);
   }
-
-  return retObj;
 }
 
 LiteralObject Interpreter::operator()(Logical &expr) {
@@ -193,7 +420,7 @@ LiteralObject Interpreter::operator()(Set &expr) {
   }
 
   LiteralObject value = evaluate(*expr.value);
-  std::get<std::shared_ptr<LoxInstance>>(value)->set(expr.name, value);
+  std::get<std::shared_ptr<LoxInstance>>(obj)->set(expr.name, value);
 
   return value;
 }
@@ -202,7 +429,81 @@ LiteralObject Interpreter::operator()(Variable &expr) {
   return lookUpVariable(expr.name, expr);
 }
 
-LiteralObject Interpreter::lookUpVariable(Token name, Variable &expr) {
+LiteralObject Interpreter::operator()(ListLiteral &expr) {
+  std::shared_ptr<LoxList> list = std::make_shared<LoxList>();
+  list->elements.reserve(expr.elements.size());
+
+  for (std::shared_ptr<Expr> element : expr.elements) {
+    list->elements.push_back(evaluate(*element));
+  }
+
+  return list;
+}
+
+LiteralObject Interpreter::operator()(Index &expr) {
+  LiteralObject obj = evaluate(*expr.object);
+  LiteralObject index = evaluate(*expr.index);
+
+  if (std::holds_alternative<std::shared_ptr<LoxMap>>(obj)) {
+    checkMapKey(expr.bracket, index);
+    LiteralObject *value =
+        std::get<std::shared_ptr<LoxMap>>(obj)->find(index);
+    return value ? *value : std::monostate{};
+  }
+
+  if (std::shared_ptr<LoxFloat64Array> array = asFloat64Array(obj))
+    return array->data[checkIndex(expr.bracket, index, array->size)];
+
+  if (!std::holds_alternative<std::shared_ptr<LoxList>>(obj)) {
+    throw new RuntimeError(expr.bracket,
+                           "Only lists, maps and Float64Arrays can be "
+                           "indexed.");
+  }
+
+  std::vector<LiteralObject> &elements =
+      std::get<std::shared_ptr<LoxList>>(obj)->elements;
+
+  return elements[checkIndex(expr.bracket, index, elements.size())];
+}
+
+LiteralObject Interpreter::operator()(SetIndex &expr) {
+  LiteralObject obj = evaluate(*expr.object);
+  LiteralObject index = evaluate(*expr.index);
+
+  if (std::holds_alternative<std::shared_ptr<LoxMap>>(obj)) {
+    checkMapKey(expr.bracket, index);
+    LiteralObject value = evaluate(*expr.value);
+    std::get<std::shared_ptr<LoxMap>>(obj)->set(index, value);
+    return value;
+  }
+
+  if (std::shared_ptr<LoxFloat64Array> array = asFloat64Array(obj)) {
+    size_t i = checkIndex(expr.bracket, index, array->size);
+    LiteralObject value = evaluate(*expr.value);
+    checkFloat64Element(expr.bracket, value);
+    array->data[i] = std::get<double>(value);
+    return value;
+  }
+
+  if (!std::holds_alternative<std::shared_ptr<LoxList>>(obj)) {
+    throw new RuntimeError(expr.bracket,
+                           "Only lists, maps and Float64Arrays can be "
+                           "indexed.");
+  }
+
+  std::vector<LiteralObject> &elements =
+      std::get<std::shared_ptr<LoxList>>(obj)->elements;
+  checkIndex(expr.bracket, index, elements.size());
+
+  LiteralObject value = evaluate(*expr.value);
+
+  // The value's evaluation may have shrunk the list since it was checked.
+  elements[checkIndex(expr.bracket, index, elements.size())] = value;
+
+  return value;
+}
+
+LiteralObject Interpreter::lookUpVariable(const Token &name, Variable &expr) {
   if (expr.id.has_value() && locals.count(expr.id.value())) {
     int distance = locals[expr.id.value()];
     LiteralObject res = environment->getAt(distance, name);
@@ -212,26 +513,29 @@ LiteralObject Interpreter::lookUpVariable(Token name, Variable &expr) {
   }
 }
 
-void Interpreter::operator()(Block &stmt) {
-  executeBlock(stmt.statements,
-               std::make_shared<Environment>(this->environment));
+Completion Interpreter::operator()(Block &stmt) {
+  return executeBlock(stmt.statements,
+                      std::make_shared<Environment>(this->environment));
 }
 
-void Interpreter::operator()(Class &stmt) {
+Completion Interpreter::operator()(Class &stmt) {
   environment->define(stmt.name.lexeme, std::monostate{});
   std::shared_ptr<LoxCallable> klass =
       std::make_shared<LoxClass>(stmt.name.lexeme);
   environment->assign(stmt.name, klass);
+
+  return Completion::NORMAL;
 }
 
-void Interpreter::operator()(Print &stmt) {
+Completion Interpreter::operator()(Print &stmt) {
   LiteralObject value = evaluate(*stmt.expr);
-  std::cout << std::visit(StringifyLiteralVisitor{}, value) << std::endl;
+  output.print(std::visit(StringifyLiteralVisitor{}, value));
+
+  return Completion::NORMAL;
 }
 
-void Interpreter::operator()(Func &func) {
-  std::shared_ptr<Func> funcPtr =
-      std::make_shared<Func>(func.name, func.params, func.body);
+Completion Interpreter::operator()(Func &func) {
+  std::shared_ptr<Func> funcPtr = std::make_shared<Func>(func);
 
   std::shared_ptr<LoxCallable> loxFunc =
       std::make_shared<LoxFunc>(funcPtr, environment);
@@ -239,51 +543,86 @@ void Interpreter::operator()(Func &func) {
   environment->define(func.name.lexeme, loxFunc);
 
   // MEM LEAK :(
+  return Completion::NORMAL;
 }
 
-void Interpreter::operator()(If &stmt) {
+Completion Interpreter::operator()(If &stmt) {
   bool conditionTrue =
       std::visit(TruthyLiteralVisitor{}, evaluate(*stmt.condition));
 
   if (conditionTrue) {
-    std::visit(*this, *(stmt.thenBranch));
+    return execute(*stmt.thenBranch);
   } else {
     if (stmt.elseBranch)
-      std::visit(*this, *(stmt.elseBranch));
+      return execute(*stmt.elseBranch);
   }
+
+  return Completion::NORMAL;
 }
 
-void Interpreter::operator()(Expression &stmt) { evaluate(*stmt.expr); }
+Completion Interpreter::operator()(Expression &stmt) {
+  evaluate(*stmt.expr);
+  return Completion::NORMAL;
+}
 
-void Interpreter::operator()(Var &stmt) {
+Completion Interpreter::operator()(Var &stmt) {
   LiteralObject value = std::monostate{};
   if (stmt.initializer != nullptr) {
     value = evaluate(*stmt.initializer);
   }
 
   environment->define(stmt.name.lexeme, value);
+  return Completion::NORMAL;
 }
 
-void Interpreter::operator()(While &stmt) {
+Completion Interpreter::operator()(While &stmt) {
   while (std::visit(TruthyLiteralVisitor{}, evaluate(*stmt.condition))) {
-    std::visit(*this, *(stmt.body));
+    Completion completion = execute(*stmt.body);
+
+    if (completion != Completion::NORMAL)
+      return completion;
   }
+
+  return Completion::NORMAL;
 }
 
-void Interpreter::operator()(Return &stmt) {
-  LiteralObject value = std::monostate{};
+Completion Interpreter::operator()(Return &stmt) {
+  // A call to a Lox function in tail position isn't made here: the callee
+  // and arguments are handed back to LoxFunc::call, which runs the callee
+  // in place of the function that is returning. Natives and classes are
+  // called as usual.
+  if (stmt.tailCall) {
+    if (Call *call = std::get_if<Call>(stmt.value.get())) {
+      tailArgs.clear();
+      tailCallee = evaluateCall(*call, tailArgs);
+
+      if (dynamic_cast<LoxFunc *>(tailCallee.get()) != nullptr)
+        return Completion::TAIL_CALL;
+
+      try {
+        returnValue = tailCallee->call(*this, std::move(tailArgs));
+      } catch (NativeError *error) {
+        throw new RuntimeError(call->paren, error->message);
+      }
+
+      tailCallee = nullptr;
+      return Completion::RETURN;
+    }
+  }
+
+  returnValue = std::monostate{};
 
   if (stmt.value != nullptr) {
-    value = evaluate(*(stmt.value));
+    returnValue = evaluate(*(stmt.value));
   }
 
-  throw new FuncReturn(value);
+  return Completion::RETURN;
 }
 
 void Interpreter::interpret(std::vector<std::shared_ptr<Stmt>> &stmts) {
   try {
     for (std::shared_ptr<Stmt> &stmt : stmts) {
-      std::visit(*this, *stmt);
+      execute(*stmt);
     }
   } catch (RuntimeError *error) {
     errorReporter.runtimeError(error);
@@ -294,23 +633,36 @@ LiteralObject Interpreter::evaluate(Expr &expr) {
   return std::visit(*this, expr);
 }
 
-void Interpreter::executeBlock(std::vector<std::shared_ptr<Stmt>> statements,
-                               std::shared_ptr<Environment> environment) {
-  std::shared_ptr<Environment> previous = this->environment;
+Completion Interpreter::execute(Stmt &stmt) {
+  Metrics::add(Metrics::STATEMENTS);
+  return std::visit(*this, stmt);
+}
+
+Completion
+Interpreter::executeBlock(const std::vector<std::shared_ptr<Stmt>> &statements,
+                          std::shared_ptr<Environment> environment) {
+  std::shared_ptr<Environment> previous = std::move(this->environment);
+  this->environment = std::move(environment);
 
   try {
-    this->environment = environment;
+    for (const std::shared_ptr<Stmt> &stmt : statements) {
+      Completion completion = execute(*stmt);
 
-    for (std::shared_ptr<Stmt> stmt : statements) {
-      std::visit(*this, *stmt);
+      if (completion != Completion::NORMAL) {
+        this->environment = std::move(previous);
+        return completion;
+      }
     }
-    this->environment = previous;
-  } catch (RuntimeError *error) {
-    this->environment = previous;
-    throw error;
+  } catch (...) {
+    this->environment = std::move(previous);
+    throw;
   }
+
+  this->environment = std::move(previous);
+  return Completion::NORMAL;
 }
 
 void Interpreter::resolve(std::shared_ptr<Expr> expr, int hops, size_t id) {
+  std::lock_guard<std::mutex> lock(localsMutex);
   locals.insert({id, hops});
 }
@@ -0,0 +1,856 @@
+#include "jit.hpp"
+#include "lox_callable.hpp"
+#include "options.hpp"
+#include "output.hpp"
+#include "runtime_error.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <unordered_map>
+#include <variant>
+
+#if defined(__x86_64__) && defined(__unix__)
+#define JIT_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+extern Options options;
+extern Output output;
+
+size_t Jit::interpreting = 0;
+int64_t Jit::depth = 0;
+
+// JitFunction
+
+JitFunction::JitFunction(std::string name) : name(name) {}
+
+JitFunction::~JitFunction() {
+#ifdef JIT_SUPPORTED
+  if (code != nullptr)
+    munmap(code, codeSize);
+#endif
+}
+
+#ifdef JIT_SUPPORTED
+
+// Where a compiled expression leaves its value: a number in xmm0, a boolean
+// as 0 or 1 in eax. NUMBER_OR_NIL is a local declared without a value,
+// which licm does for a temporary it fills on first use with
+// 'temp or (temp = expr)'; that is the one way such a local may be read.
+enum class JitType { NUMBER, BOOLEAN, NUMBER_OR_NIL };
+
+// Stands for nil in a NUMBER_OR_NIL local; no arithmetic produces this NaN.
+constexpr uint64_t NIL_BITS = 0x7ff8dead00000000;
+
+// Compiles one function to x86-64 following the System V ABI.
+//
+// The frame keeps rbx (result pointer), r12 (depth counter) and r13
+// (arguments) below the saved rbp, then one 8-byte slot per parameter and
+// local; slot 0 receives call results. Temporaries are pushed on the stack,
+// with the pushes counted so calls are made with rsp 16-byte aligned.
+// Numbers in NUMBER_OR_NIL slots are stored as is and nil as NIL_BITS.
+class JitCompiler {
+private:
+  struct Local {
+    int32_t offset;
+    JitType type;
+  };
+
+  struct Label {
+    size_t position{0};
+    std::vector<size_t> fixups{};
+  };
+
+  JitFunction &function;
+  Func &func;
+  Interpreter &interpreter;
+  std::vector<uint8_t> code{};
+  std::vector<std::unordered_map<std::string, Local>> scopes{};
+  std::vector<Label> labels{};
+  size_t slots{1};
+  size_t pushed{0};
+  bool supported{true};
+  size_t bodyLabel;
+  size_t bailoutLabel;
+  size_t exitLabel;
+
+  static int32_t slotOffset(size_t slot) { return -32 - 8 * slot; }
+
+  void emit(std::initializer_list<uint8_t> bytes) {
+    code.insert(code.end(), bytes);
+  }
+
+  void emit32(uint32_t value) {
+    for (int i = 0; i < 4; i++)
+      code.push_back(value >> (8 * i));
+  }
+
+  void emit64(uint64_t value) {
+    emit32(value);
+    emit32(value >> 32);
+  }
+
+  // ModRM for [rbp + offset] with the given register field.
+  void rbpOperand(uint8_t reg, int32_t offset) {
+    code.push_back(0x85 | reg << 3);
+    emit32(offset);
+  }
+
+  size_t newLabel() {
+    labels.emplace_back();
+    return labels.size() - 1;
+  }
+
+  void bind(size_t label) { labels[label].position = code.size(); }
+
+  void jump(std::initializer_list<uint8_t> opcode, size_t label) {
+    emit(opcode);
+    labels[label].fixups.push_back(code.size());
+    emit32(0);
+  }
+
+  void jmp(size_t label) { jump({0xE9}, label); }
+  void jz(size_t label) { jump({0x0F, 0x84}, label); }
+  void jnz(size_t label) { jump({0x0F, 0x85}, label); }
+  void jg(size_t label) { jump({0x0F, 0x8F}, label); }
+
+  JitType unsupported() {
+    supported = false;
+    return JitType::NUMBER;
+  }
+
+  void expect(JitType type, JitType wanted) {
+    if (type != wanted)
+      supported = false;
+  }
+
+  bool isLocal(const std::optional<size_t> &id) const {
+    return id.has_value() && interpreter.locals.count(id.value());
+  }
+
+  const Local *lookUp(const std::string &name) const {
+    for (auto scope = scopes.rbegin(); scope != scopes.rend(); scope++) {
+      auto local = scope->find(name);
+      if (local != scope->end())
+        return &local->second;
+    }
+
+    return nullptr;
+  }
+
+  void loadNumber(uint64_t bits) {
+    emit({0x48, 0xB8}); // mov rax, imm64
+    emit64(bits);
+    emit({0x66, 0x48, 0x0F, 0x6E, 0xC0}); // movq xmm0, rax
+  }
+
+  void load(const Local &local) {
+    if (local.type == JitType::BOOLEAN) {
+      emit({0x48, 0x8B}); // mov rax, [rbp + offset]
+    } else {
+      emit({0xF2, 0x0F, 0x10}); // movsd xmm0, [rbp + offset]
+    }
+    rbpOperand(0, local.offset);
+  }
+
+  void store(const Local &local) {
+    if (local.type == JitType::BOOLEAN) {
+      emit({0x48, 0x89}); // mov [rbp + offset], rax
+    } else {
+      emit({0xF2, 0x0F, 0x11}); // movsd [rbp + offset], xmm0
+    }
+    rbpOperand(0, local.offset);
+  }
+
+  void push(JitType type) {
+    if (type == JitType::BOOLEAN) {
+      emit({0x50}); // push rax
+    } else {
+      emit({0x48, 0x83, 0xEC, 0x08});       // sub rsp, 8
+      emit({0xF2, 0x0F, 0x11, 0x04, 0x24}); // movsd [rsp], xmm0
+    }
+    pushed++;
+  }
+
+  void pop(JitType type) {
+    if (type == JitType::BOOLEAN) {
+      emit({0x58}); // pop rax
+    } else {
+      emit({0xF2, 0x0F, 0x10, 0x04, 0x24}); // movsd xmm0, [rsp]
+      emit({0x48, 0x83, 0xC4, 0x08});       // add rsp, 8
+    }
+    pushed--;
+  }
+
+  void dropStack(size_t count) {
+    emit({0x48, 0x81, 0xC4}); // add rsp, imm32
+    emit32(8 * count);
+    pushed -= count;
+  }
+
+  // Pushes the arguments last to first, so they lie in order from rsp up,
+  // padded to keep rsp aligned. Returns the number of slots pushed.
+  size_t pushArgs(std::vector<std::shared_ptr<Expr>> &args) {
+    size_t count = args.size();
+
+    if ((pushed + count) % 2 != 0) {
+      emit({0x48, 0x83, 0xEC, 0x08}); // sub rsp, 8
+      pushed++;
+      count++;
+    }
+
+    for (auto arg = args.rbegin(); arg != args.rend(); arg++) {
+      expect(compile(**arg), JitType::NUMBER);
+      push(JitType::NUMBER);
+    }
+
+    return count;
+  }
+
+  bool isSelfCall(Call &call) const {
+    Variable *callee = std::get_if<Variable>(call.callee.get());
+
+    // Memoized functions call themselves through their cache.
+    return callee != nullptr && !isLocal(callee->id) &&
+           callee->name.lexeme == func.name.lexeme && func.memo == nullptr &&
+           call.args.size() == func.params.size();
+  }
+
+  JitType compile(Expr &expr) { return std::visit(*this, expr); }
+
+public:
+  JitCompiler(JitFunction &function, Func &func, Interpreter &interpreter)
+      : function(function), func(func), interpreter(interpreter) {}
+
+  bool compile(std::vector<uint8_t> &out) {
+    bodyLabel = newLabel();
+    bailoutLabel = newLabel();
+    exitLabel = newLabel();
+
+    emit({0x55});                   // push rbp
+    emit({0x48, 0x89, 0xE5});       // mov rbp, rsp
+    emit({0x53});                   // push rbx
+    emit({0x41, 0x54});             // push r12
+    emit({0x41, 0x55});             // push r13
+    emit({0x48, 0x81, 0xEC});       // sub rsp, imm32
+    size_t frameSize = code.size(); // patched below
+    emit32(0);
+    emit({0x49, 0x89, 0xFD});       // mov r13, rdi
+    emit({0x48, 0x89, 0xF3});       // mov rbx, rsi
+    emit({0x49, 0x89, 0xD4});       // mov r12, rdx
+    emit({0x49, 0xFF, 0x04, 0x24}); // inc qword [r12]
+    emit({0x49, 0x81, 0x3C, 0x24}); // cmp qword [r12], imm32
+    emit32(Jit::MAX_DEPTH);
+    jg(bailoutLabel);
+
+    scopes.emplace_back();
+
+    for (const Token &param : func.params) {
+      Local local{slotOffset(slots++), JitType::NUMBER};
+      scopes.back()[param.lexeme] = local;
+
+      emit({0xF2, 0x41, 0x0F, 0x10, 0x85}); // movsd xmm0, [r13 + disp32]
+      emit32(8 * (slots - 2));
+      store(local);
+    }
+
+    bind(bodyLabel);
+
+    for (std::shared_ptr<Stmt> &stmt : func.body) {
+      std::visit(*this, *stmt);
+    }
+
+    emit({0xB8}); // mov eax, NIL
+    emit32(Jit::NIL);
+    jmp(exitLabel);
+
+    bind(bailoutLabel);
+    emit({0x31, 0xC0}); // xor eax, eax
+
+    bind(exitLabel);
+    emit({0x49, 0xFF, 0x0C, 0x24}); // dec qword [r12]
+    emit({0x48, 0x8D, 0x65, 0xE8}); // lea rsp, [rbp - 24]
+    emit({0x41, 0x5D});             // pop r13
+    emit({0x41, 0x5C});             // pop r12
+    emit({0x5B});                   // pop rbx
+    emit({0x5D});                   // pop rbp
+    emit({0xC3});                   // ret
+
+    // With the three saved registers this leaves rsp 16-byte aligned.
+    uint32_t frame = 8 * slots;
+    if (frame % 16 == 0)
+      frame += 8;
+    std::memcpy(&code[frameSize], &frame, sizeof(frame));
+
+    for (const Label &label : labels) {
+      for (size_t fixup : label.fixups) {
+        int32_t rel = label.position - (fixup + 4);
+        std::memcpy(&code[fixup], &rel, sizeof(rel));
+      }
+    }
+
+    out = std::move(code);
+    return supported;
+  }
+
+  JitType operator()(Assign &expr) {
+    const Local *local = isLocal(expr.id) ? lookUp(expr.name.lexeme) : nullptr;
+
+    if (local == nullptr)
+      return unsupported();
+
+    JitType type = compile(*expr.value);
+
+    if (type != local->type &&
+        !(type == JitType::NUMBER && local->type == JitType::NUMBER_OR_NIL))
+      return unsupported();
+
+    store(*local);
+    return type;
+  }
+
+  JitType operator()(Logical &expr) {
+    size_t end = newLabel();
+    JitType left = std::holds_alternative<Call>(*expr.left)
+                       ? condition(*expr.left)
+                       : compile(*expr.left);
+
+    // nil is the only falsy value such a local holds.
+    if (left == JitType::NUMBER_OR_NIL && expr.op.type == TokenType::OR) {
+      emit({0x66, 0x48, 0x0F, 0x7E, 0xC0}); // movq rax, xmm0
+      emit({0x48, 0xB9});                   // mov rcx, imm64
+      emit64(NIL_BITS);
+      emit({0x48, 0x39, 0xC8}); // cmp rax, rcx
+      jnz(end);
+      expect(compile(*expr.right), JitType::NUMBER);
+      bind(end);
+      return JitType::NUMBER;
+    }
+
+    expect(left, JitType::BOOLEAN);
+    emit({0x85, 0xC0}); // test eax, eax
+
+    if (expr.op.type == TokenType::OR) {
+      jnz(end);
+    } else {
+      jz(end);
+    }
+
+    condition(*expr.right);
+    bind(end);
+    return JitType::BOOLEAN;
+  }
+
+  template <TokenType OP> JitType operator()(BinaryOp<OP> &expr) {
+    JitType left = compile(*expr.left);
+    push(left);
+    JitType right = compile(*expr.right);
+
+    if (left == JitType::NUMBER_OR_NIL || right == JitType::NUMBER_OR_NIL)
+      return unsupported();
+
+    if (right == JitType::BOOLEAN) {
+      emit({0x89, 0xC1}); // mov ecx, eax
+    } else {
+      emit({0x66, 0x0F, 0x28, 0xC8}); // movapd xmm1, xmm0
+    }
+    pop(left);
+
+    if constexpr (OP == TokenType::EQUAL_EQUAL ||
+                  OP == TokenType::BANG_EQUAL) {
+      bool equal = OP == TokenType::EQUAL_EQUAL;
+
+      if (left != right) {
+        emit({0xB8}); // mov eax, imm32
+        emit32(!equal);
+        return JitType::BOOLEAN;
+      }
+
+      if (left == JitType::BOOLEAN) {
+        emit({0x39, 0xC8}); // cmp eax, ecx
+        emit({0x0F, static_cast<uint8_t>(equal ? 0x94 : 0x95), 0xC0});
+      } else {
+        // Unordered (NaN) operands set ZF and PF: equal needs PF clear.
+        emit({0x66, 0x0F, 0x2E, 0xC1}); // ucomisd xmm0, xmm1
+        if (equal) {
+          emit({0x0F, 0x94, 0xC0}); // sete al
+          emit({0x0F, 0x9B, 0xC1}); // setnp cl
+          emit({0x20, 0xC8});       // and al, cl
+        } else {
+          emit({0x0F, 0x95, 0xC0}); // setne al
+          emit({0x0F, 0x9A, 0xC1}); // setp cl
+          emit({0x08, 0xC8});       // or al, cl
+        }
+      }
+
+      emit({0x0F, 0xB6, 0xC0}); // movzx eax, al
+      return JitType::BOOLEAN;
+    } else {
+      if (left != JitType::NUMBER || right != JitType::NUMBER)
+        return unsupported();
+
+      if constexpr (OP == TokenType::PLUS) {
+        emit({0xF2, 0x0F, 0x58, 0xC1}); // addsd xmm0, xmm1
+      } else if constexpr (OP == TokenType::MINUS) {
+        emit({0xF2, 0x0F, 0x5C, 0xC1}); // subsd xmm0, xmm1
+      } else if constexpr (OP == TokenType::STAR) {
+        emit({0xF2, 0x0F, 0x59, 0xC1}); // mulsd xmm0, xmm1
+      } else if constexpr (OP == TokenType::SLASH) {
+        emit({0xF2, 0x0F, 0x5E, 0xC1}); // divsd xmm0, xmm1
+      } else {
+        // seta/setae are false on unordered operands, as comparisons with
+        // NaN must be; less-than compares with the operands swapped.
+        if constexpr (OP == TokenType::LESS ||
+                      OP == TokenType::LESS_EQUAL) {
+          emit({0x66, 0x0F, 0x2E, 0xC8}); // ucomisd xmm1, xmm0
+        } else {
+          emit({0x66, 0x0F, 0x2E, 0xC1}); // ucomisd xmm0, xmm1
+        }
+
+        if constexpr (OP == TokenType::LESS || OP == TokenType::GREATER) {
+          emit({0x0F, 0x97, 0xC0}); // seta al
+        } else {
+          emit({0x0F, 0x93, 0xC0}); // setae al
+        }
+
+        emit({0x0F, 0xB6, 0xC0}); // movzx eax, al
+        return JitType::BOOLEAN;
+      }
+
+      return JitType::NUMBER;
+    }
+  }
+
+  // Emits a call leaving the callee's Jit::Result in eax and its value, if
+  // any, in the result slot.
+  void emitCall(Call &expr) {
+    Variable *callee = std::get_if<Variable>(expr.callee.get());
+
+    if (callee == nullptr || isLocal(callee->id)) {
+      unsupported();
+      return;
+    }
+
+    bool self = isSelfCall(expr);
+    size_t count = pushArgs(expr.args);
+
+    if (self) {
+      emit({0x48, 0x89, 0xE7}); // mov rdi, rsp
+      emit({0x48, 0x8D});       // lea rsi, [rbp + result slot]
+      rbpOperand(6, slotOffset(0));
+      emit({0x4C, 0x89, 0xE2}); // mov rdx, r12
+      emit({0xE8});             // call entry
+      emit32(-static_cast<int32_t>(code.size() + 4));
+    } else {
+      uint32_t index = function.callees.size();
+      function.callees.push_back({callee->name, expr.args.size()});
+
+      emit({0x48, 0xBF}); // mov rdi, imm64
+      emit64(reinterpret_cast<uint64_t>(&function));
+      emit({0xBE}); // mov esi, imm32
+      emit32(index);
+      emit({0x48, 0x89, 0xE2}); // mov rdx, rsp
+      emit({0x48, 0x8D});       // lea rcx, [rbp + result slot]
+      rbpOperand(1, slotOffset(0));
+      emit({0x48, 0xB8}); // mov rax, imm64
+      emit64(reinterpret_cast<uint64_t>(&Jit::callOut));
+      emit({0xFF, 0xD0}); // call rax
+    }
+
+    dropStack(count);
+  }
+
+  // Compiles an expression that has to give a boolean. A call's result type
+  // is only known when it returns, so it is checked to be one.
+  JitType condition(Expr &expr) {
+    Call *call = std::get_if<Call>(&expr);
+
+    if (call == nullptr) {
+      expect(compile(expr), JitType::BOOLEAN);
+      return JitType::BOOLEAN;
+    }
+
+    emitCall(*call);
+    emit({0x83, 0xF8, Jit::BOOLEAN}); // cmp eax, BOOLEAN
+    jnz(bailoutLabel);
+    emit({0xF2, 0x0F, 0x2C}); // cvttsd2si eax, [rbp + result slot]
+    rbpOperand(0, slotOffset(0));
+    return JitType::BOOLEAN;
+  }
+
+  JitType operator()(Call &expr) {
+    emitCall(expr);
+    emit({0x83, 0xF8, Jit::NUMBER}); // cmp eax, NUMBER
+    jnz(bailoutLabel);
+    emit({0xF2, 0x0F, 0x10}); // movsd xmm0, [rbp + result slot]
+    rbpOperand(0, slotOffset(0));
+    return JitType::NUMBER;
+  }
+
+  JitType operator()(Get &expr) { return unsupported(); }
+
+  JitType operator()(Set &expr) { return unsupported(); }
+
+  JitType operator()(Grouping &expr) { return compile(*expr.expression); }
+
+  JitType operator()(Literal &expr) {
+    if (const double *num = std::get_if<double>(&expr.value)) {
+      uint64_t bits;
+      std::memcpy(&bits, num, sizeof(bits));
+      loadNumber(bits);
+      return JitType::NUMBER;
+    }
+
+    if (const bool *val = std::get_if<bool>(&expr.value)) {
+      emit({0xB8}); // mov eax, imm32
+      emit32(*val);
+      return JitType::BOOLEAN;
+    }
+
+    return unsupported();
+  }
+
+  JitType operator()(Unary &expr) {
+    JitType type = compile(*expr.right);
+
+    if (expr.op.type == TokenType::MINUS) {
+      expect(type, JitType::NUMBER);
+      emit({0x48, 0xB8}); // mov rax, sign bit
+      emit64(0x8000000000000000);
+      emit({0x66, 0x48, 0x0F, 0x6E, 0xC8}); // movq xmm1, rax
+      emit({0x66, 0x0F, 0x57, 0xC1});       // xorpd xmm0, xmm1
+      return type;
+    }
+
+    if (type == JitType::BOOLEAN) {
+      emit({0x83, 0xF0, 0x01}); // xor eax, 1
+    } else {
+      expect(type, JitType::NUMBER);
+      emit({0x31, 0xC0}); // xor eax, eax
+    }
+
+    return JitType::BOOLEAN;
+  }
+
+  JitType operator()(Variable &expr) {
+    if (isLocal(expr.id)) {
+      const Local *local = lookUp(expr.name.lexeme);
+
+      if (local == nullptr)
+        return unsupported();
+
+      load(*local);
+      return local->type;
+    }
+
+    // The function is pure, so a global it reads as a value is a constant
+    // that already has its final value if it is defined at all.
+    LiteralObject value{};
+
+    try {
+      value = interpreter.globals->get(expr.name);
+    } catch (RuntimeError *error) {
+      delete error;
+      return unsupported();
+    }
+
+    Literal literal(value);
+    return (*this)(literal);
+  }
+
+  JitType operator()(ListLiteral &expr) { return unsupported(); }
+
+  JitType operator()(Index &expr) { return unsupported(); }
+
+  JitType operator()(SetIndex &expr) { return unsupported(); }
+
+  void operator()(Block &stmt) {
+    scopes.emplace_back();
+
+    for (std::shared_ptr<Stmt> &statement : stmt.statements) {
+      std::visit(*this, *statement);
+    }
+
+    scopes.pop_back();
+  }
+
+  void operator()(Class &stmt) { unsupported(); }
+
+  void operator()(Expression &stmt) { compile(*stmt.expr); }
+
+  void operator()(Func &stmt) { unsupported(); }
+
+  void operator()(If &stmt) {
+    size_t elseLabel = newLabel();
+
+    condition(*stmt.condition);
+    emit({0x85, 0xC0}); // test eax, eax
+    jz(elseLabel);
+    std::visit(*this, *stmt.thenBranch);
+
+    if (stmt.elseBranch != nullptr) {
+      size_t end = newLabel();
+
+      jmp(end);
+      bind(elseLabel);
+      std::visit(*this, *stmt.elseBranch);
+      bind(end);
+    } else {
+      bind(elseLabel);
+    }
+  }
+
+  void operator()(Print &stmt) { unsupported(); }
+
+  void operator()(Return &stmt) {
+    Literal *literal = stmt.value == nullptr
+                           ? nullptr
+                           : std::get_if<Literal>(stmt.value.get());
+
+    if (stmt.value == nullptr ||
+        (literal != nullptr &&
+         std::holds_alternative<std::monostate>(literal->value))) {
+      emit({0xB8}); // mov eax, NIL
+      emit32(Jit::NIL);
+      jmp(exitLabel);
+      return;
+    }
+
+    // Returning a call to itself reruns the body with the new arguments.
+    Call *call = std::get_if<Call>(stmt.value.get());
+
+    if (call != nullptr && isSelfCall(*call)) {
+      for (auto arg = call->args.rbegin(); arg != call->args.rend(); arg++) {
+        expect(compile(**arg), JitType::NUMBER);
+        push(JitType::NUMBER);
+      }
+
+      for (size_t i = 0; i < call->args.size(); i++) {
+        pop(JitType::NUMBER);
+        store(Local{slotOffset(i + 1), JitType::NUMBER});
+      }
+
+      jmp(bodyLabel);
+      return;
+    }
+
+    // Any other call's result, of whatever type, is returned as it is.
+    if (call != nullptr) {
+      emitCall(*call);
+      emit({0x85, 0xC0}); // test eax, eax
+      jz(bailoutLabel);
+      emit({0xF2, 0x0F, 0x10}); // movsd xmm0, [rbp + result slot]
+      rbpOperand(0, slotOffset(0));
+      emit({0xF2, 0x0F, 0x11, 0x03}); // movsd [rbx], xmm0
+      jmp(exitLabel);
+      return;
+    }
+
+    JitType type = compile(*stmt.value);
+
+    if (type == JitType::BOOLEAN)
+      emit({0xF2, 0x0F, 0x2A, 0xC0}); // cvtsi2sd xmm0, eax
+    else
+      expect(type, JitType::NUMBER);
+
+    emit({0xF2, 0x0F, 0x11, 0x03}); // movsd [rbx], xmm0
+    emit({0xB8});                   // mov eax, imm32
+    emit32(type == JitType::BOOLEAN ? Jit::BOOLEAN : Jit::NUMBER);
+    jmp(exitLabel);
+  }
+
+  void operator()(Var &stmt) {
+    JitType type = JitType::NUMBER_OR_NIL;
+
+    if (stmt.initializer != nullptr) {
+      type = compile(*stmt.initializer);
+      if (type == JitType::NUMBER_OR_NIL)
+        unsupported();
+    } else {
+      loadNumber(NIL_BITS);
+    }
+
+    Local local{slotOffset(slots++), type};
+    store(local);
+    scopes.back()[stmt.name.lexeme] = local;
+  }
+
+  void operator()(While &stmt) {
+    size_t top = newLabel();
+    size_t end = newLabel();
+
+    bind(top);
+    condition(*stmt.condition);
+    emit({0x85, 0xC0}); // test eax, eax
+    jz(end);
+    std::visit(*this, *stmt.body);
+    jmp(top);
+    bind(end);
+  }
+};
+
+#endif
+
+// Jit
+
+bool Jit::compile(JitFunction &function, Func &func,
+                  Interpreter &interpreter) {
+#ifdef JIT_SUPPORTED
+  if (func.params.size() > MAX_ARGS)
+    return false;
+
+  function.interpreter = &interpreter;
+
+  std::vector<uint8_t> code{};
+  JitCompiler compiler(function, func, interpreter);
+
+  if (!compiler.compile(code))
+    return false;
+
+  void *memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (memory == MAP_FAILED)
+    return false;
+
+  std::memcpy(memory, code.data(), code.size());
+
+  if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+    munmap(memory, code.size());
+    return false;
+  }
+
+  function.code = memory;
+  function.codeSize = code.size();
+  function.entry = reinterpret_cast<JitFunction::Entry>(memory);
+  return true;
+#else
+  return false;
+#endif
+}
+
+Jit::Outcome Jit::run(JitFunction &function, Func &func,
+                      Interpreter &interpreter,
+                      const std::vector<LiteralObject> &args,
+                      LiteralObject &result) {
+  if (function.entry == nullptr) {
+    size_t threshold = options.jitVerify ? 1 : HOT_THRESHOLD;
+
+    if (function.failed || ++function.calls < threshold)
+      return Outcome::NOT_RUN;
+
+    if (!compile(function, func, interpreter)) {
+      function.failed = true;
+      return Outcome::NOT_RUN;
+    }
+  }
+
+  if (function.deoptimized)
+    return Outcome::NOT_RUN;
+
+  double values[MAX_ARGS];
+
+  for (size_t i = 0; i < args.size(); i++) {
+    const double *num = std::get_if<double>(&args[i]);
+
+    if (num == nullptr) {
+      function.guardMisses++;
+      return Outcome::NOT_RUN;
+    }
+
+    values[i] = *num;
+  }
+
+  double value;
+
+  switch (function.entry(values, &value, &depth)) {
+  case NUMBER:
+    result = value;
+    break;
+  case BOOLEAN:
+    result = value != 0;
+    break;
+  case NIL:
+    result = std::monostate{};
+    break;
+  default:
+    // Code that keeps bailing out costs more than it saves.
+    if (++function.bailouts >= HOT_THRESHOLD &&
+        function.bailouts * 8 > function.nativeCalls)
+      function.deoptimized = true;
+
+    return Outcome::BAILED_OUT;
+  }
+
+  function.nativeCalls++;
+  return Outcome::RAN;
+}
+
+bool Jit::nested() { return depth > 0; }
+
+void Jit::verify(const JitFunction &function,
+                 const std::vector<LiteralObject> &args,
+                 const LiteralObject &native, const LiteralObject &walked) {
+  const double *a = std::get_if<double>(&native);
+  const double *b = std::get_if<double>(&walked);
+
+  if (a != nullptr && b != nullptr) {
+    if (std::memcmp(a, b, sizeof(double)) == 0 || (*a != *a && *b != *b))
+      return;
+  } else if (native == walked) {
+    return;
+  }
+
+  std::cerr << "jit: " << function.name << "(";
+
+  for (size_t i = 0; i < args.size(); i++) {
+    std::cerr << (i == 0 ? "" : ", ")
+              << std::visit(StringifyLiteralVisitor{}, args[i]);
+  }
+
+  std::cerr << ") returned " << std::visit(StringifyLiteralVisitor{}, native)
+            << " natively but "
+            << std::visit(StringifyLiteralVisitor{}, walked)
+            << " interpreted\n";
+  output.flush();
+  std::abort();
+}
+
+int Jit::callOut(JitFunction *caller, uint32_t index, const double *args,
+                 double *result) {
+  const JitFunction::Callee &callee = caller->callees[index];
+
+  // Nothing may unwind through native frames, so every error becomes a
+  // bailout; the tree-walker reports it when it reruns the call.
+  int status = BAILOUT;
+  depth += CALL_OUT_DEPTH;
+
+  try {
+    LiteralObject value = caller->interpreter->globals->get(callee.name);
+    const auto *function = std::get_if<std::shared_ptr<LoxCallable>>(&value);
+
+    if (function != nullptr &&
+        (*function)->arity() == static_cast<int>(callee.arity)) {
+      LiteralObject returned = (*function)->call(
+          *caller->interpreter,
+          std::vector<LiteralObject>(args, args + callee.arity));
+
+      if (const double *num = std::get_if<double>(&returned)) {
+        *result = *num;
+        status = NUMBER;
+      } else if (const bool *val = std::get_if<bool>(&returned)) {
+        *result = *val;
+        status = BOOLEAN;
+      } else if (std::holds_alternative<std::monostate>(returned)) {
+        status = NIL;
+      }
+    }
+  } catch (RuntimeError *error) {
+    delete error;
+  } catch (...) {
+  }
+
+  depth -= CALL_OUT_DEPTH;
+  return status;
+}
@@ -0,0 +1,52 @@
+#include "jit_compilation.hpp"
+#include "options.hpp"
+#include "purity_analysis.hpp"
+#include <memory>
+
+extern Options options;
+
+JitCompilation::JitCompilation(Interpreter &interpreter)
+    : interpreter(interpreter) {}
+
+std::string JitCompilation::name() const { return "jit"; }
+
+void JitCompilation::run(std::vector<std::shared_ptr<Stmt>> &statements) {
+  if (options.interactive)
+    return;
+
+  PurityAnalysis purity(interpreter);
+  purity.run(statements);
+  functions = purity.topLevelFunctions;
+
+  for (Func *func : purity.pureFunctions) {
+    func->jit = std::make_shared<JitFunction>(func->name.lexeme);
+    candidates.push_back(func->jit);
+  }
+}
+
+void JitCompilation::report(std::ostream &out) const {
+  size_t compiled = 0;
+
+  for (const std::shared_ptr<JitFunction> &function : candidates) {
+    if (function->entry != nullptr)
+      compiled++;
+  }
+
+  out << "jit: " << candidates.size() << " of " << functions
+      << " top-level functions pure, " << compiled << " compiled\n";
+
+  for (const std::shared_ptr<JitFunction> &function : candidates) {
+    out << "  " << function->name << ": ";
+
+    if (function->entry != nullptr) {
+      out << function->codeSize << " bytes, " << function->nativeCalls
+          << " native calls, " << function->bailouts << " bailouts, "
+          << function->guardMisses << " guard misses"
+          << (function->deoptimized ? ", deoptimized" : "") << "\n";
+    } else if (function->failed) {
+      out << "not compilable\n";
+    } else {
+      out << "not hot (" << function->calls << " calls)\n";
+    }
+  }
+}
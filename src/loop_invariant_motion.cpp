@@ -0,0 +1,437 @@
+#include "loop_invariant_motion.hpp"
+#include "resolver.hpp"
+#include <memory>
+#include <variant>
+
+// Child slots of a node, for the hoisting walk. A slot is the shared_ptr
+// holding the child, so the child can be replaced in place.
+
+struct ExprSlots {
+  std::vector<std::shared_ptr<Expr> *> operator()(Assign &expr) {
+    return {&expr.value};
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Logical &expr) {
+    return {&expr.left, &expr.right};
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Binary &expr) {
+    return {&expr.left, &expr.right};
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Call &expr) {
+    std::vector<std::shared_ptr<Expr> *> slots{&expr.callee};
+
+    for (std::shared_ptr<Expr> &arg : expr.args) {
+      slots.push_back(&arg);
+    }
+
+    return slots;
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Get &expr) {
+    return {&expr.object};
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Set &expr) {
+    return {&expr.object, &expr.value};
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Grouping &expr) {
+    return {&expr.expression};
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Literal &expr) { return {}; }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Unary &expr) {
+    return {&expr.right};
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Variable &expr) {
+    return {};
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(ListLiteral &expr) {
+    std::vector<std::shared_ptr<Expr> *> slots{};
+
+    for (std::shared_ptr<Expr> &element : expr.elements) {
+      slots.push_back(&element);
+    }
+
+    return slots;
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(Index &expr) {
+    return {&expr.object, &expr.index};
+  }
+
+  std::vector<std::shared_ptr<Expr> *> operator()(SetIndex &expr) {
+    return {&expr.object, &expr.index, &expr.value};
+  }
+};
+
+LoopInvariantMotion::LoopInvariantMotion(Interpreter &interpreter)
+    : interpreter(interpreter) {}
+
+std::string LoopInvariantMotion::name() const { return "licm"; }
+
+void LoopInvariantMotion::run(std::vector<std::shared_ptr<Stmt>> &statements) {
+  analyze(statements);
+
+  // Loops were recorded as they closed, so inner loops come first and
+  // whatever they hoist can be hoisted again out of the enclosing loop.
+  for (Loop &loop : loops) {
+    std::vector<std::shared_ptr<Stmt>> hoisted{};
+    While &stmt = std::get<While>(**loop.slot);
+
+    hoist(loop, stmt.condition, hoisted);
+    hoist(loop, stmt.body, hoisted);
+
+    if (hoisted.empty())
+      continue;
+
+    changedLoops++;
+    hoisted.push_back(*loop.slot);
+    *loop.slot = std::make_shared<Stmt>(Block(hoisted));
+  }
+
+  if (changedLoops > 0)
+    Resolver(interpreter).resolve(statements);
+}
+
+void LoopInvariantMotion::report(std::ostream &out) const {
+  out << "licm: " << hoistedExprs << " expressions hoisted out of "
+      << changedLoops << " of " << loops.size() << " loops\n";
+}
+
+// Hoisting
+
+bool LoopInvariantMotion::isTrivial(const std::shared_ptr<Expr> &expr) {
+  if (Grouping *grouping = std::get_if<Grouping>(expr.get()))
+    return isTrivial(grouping->expression);
+
+  // Bare literals and variables are as cheap to evaluate as the temporary
+  // that would replace them.
+  return std::holds_alternative<Literal>(*expr) ||
+         std::holds_alternative<Variable>(*expr);
+}
+
+bool LoopInvariantMotion::isArithmetic(const std::shared_ptr<Expr> &expr) {
+  if (Unary *unary = std::get_if<Unary>(expr.get()))
+    return unary->op.type == TokenType::MINUS;
+
+  return std::holds_alternative<Add>(*expr) ||
+         std::holds_alternative<Subtract>(*expr) ||
+         std::holds_alternative<Multiply>(*expr) ||
+         std::holds_alternative<Divide>(*expr);
+}
+
+Token LoopInvariantMotion::temporary() {
+  // '$' can't appear in a Lox identifier, so these never clash with
+  // the program's own names.
+  return Token(TokenType::IDENTIFIER, "$licm" + std::to_string(temporaries++),
+               std::monostate{}, 0);
+}
+
+bool LoopInvariantMotion::isVariant(const Loop &loop, size_t decl) const {
+  return (decl >= loop.firstDecl && decl < loop.endDecl) ||
+         loop.assigned.count(decl) || capturedWrites.count(decl);
+}
+
+bool LoopInvariantMotion::isInvariant(const Loop &loop,
+                                      const std::shared_ptr<Expr> &expr) {
+  if (std::holds_alternative<Literal>(*expr))
+    return true;
+
+  if (Grouping *grouping = std::get_if<Grouping>(expr.get()))
+    return isInvariant(loop, grouping->expression);
+
+  if (Variable *variable = std::get_if<Variable>(expr.get())) {
+    if (!variable->id.has_value() || !declOf.count(variable->id.value()))
+      return false;
+
+    return !isVariant(loop, declOf[variable->id.value()]);
+  }
+
+  if (Unary *unary = std::get_if<Unary>(expr.get()))
+    return isInvariant(loop, unary->right);
+
+  if (Binary *binary = std::visit(AsBinary{}, *expr))
+    return isInvariant(loop, binary->left) && isInvariant(loop, binary->right);
+
+  return false;
+}
+
+bool LoopInvariantMotion::cannotFail(const std::shared_ptr<Expr> &expr) {
+  if (std::holds_alternative<Literal>(*expr) ||
+      std::holds_alternative<Variable>(*expr))
+    return true;
+
+  if (Grouping *grouping = std::get_if<Grouping>(expr.get()))
+    return cannotFail(grouping->expression);
+
+  if (Unary *unary = std::get_if<Unary>(expr.get())) {
+    if (unary->op.type == TokenType::MINUS &&
+        unary->operandType != StaticType::NUMBER)
+      return false;
+
+    return cannotFail(unary->right);
+  }
+
+  if (Binary *binary = std::visit(AsBinary{}, *expr)) {
+    bool checked = binary->op.type != TokenType::EQUAL_EQUAL &&
+                   binary->op.type != TokenType::BANG_EQUAL;
+
+    if (checked && binary->operandType != StaticType::NUMBER)
+      return false;
+
+    return cannotFail(binary->left) && cannotFail(binary->right);
+  }
+
+  return false;
+}
+
+void LoopInvariantMotion::hoist(Loop &loop, std::shared_ptr<Expr> &expr,
+                                std::vector<std::shared_ptr<Stmt>> &hoisted) {
+  if (expr == nullptr)
+    return;
+
+  if (isInvariant(loop, expr)) {
+    if (cannotFail(expr) && !isTrivial(expr)) {
+      Token name = temporary();
+
+      hoisted.push_back(std::make_shared<Stmt>(Var(name, expr)));
+      expr = std::make_shared<Expr>(Variable(name));
+      hoistedExprs++;
+      return;
+    }
+
+    // An expression that might fail has to fail where it always did, and
+    // only if it is reached at all, so it is computed on first use inside
+    // the loop instead: 'temp or (temp = expr)'. Arithmetic only produces
+    // numbers and strings, which are truthy, so the cached value sticks.
+    if (isArithmetic(expr)) {
+      Token name = temporary();
+      Token orToken(TokenType::OR, "or", std::monostate{}, name.line);
+
+      hoisted.push_back(std::make_shared<Stmt>(Var(name, nullptr)));
+      expr = std::make_shared<Expr>(
+          Logical(std::make_shared<Expr>(Variable(name)), orToken,
+                  std::make_shared<Expr>(Assign(name, expr))));
+      hoistedExprs++;
+      return;
+    }
+  }
+
+  for (std::shared_ptr<Expr> *child : std::visit(ExprSlots{}, *expr)) {
+    hoist(loop, *child, hoisted);
+  }
+}
+
+void LoopInvariantMotion::hoist(Loop &loop, std::shared_ptr<Stmt> &stmt,
+                                std::vector<std::shared_ptr<Stmt>> &hoisted) {
+  if (stmt == nullptr)
+    return;
+
+  if (Block *block = std::get_if<Block>(stmt.get())) {
+    for (std::shared_ptr<Stmt> &inner : block->statements) {
+      hoist(loop, inner, hoisted);
+    }
+  } else if (Expression *expression = std::get_if<Expression>(stmt.get())) {
+    hoist(loop, expression->expr, hoisted);
+  } else if (If *ifStmt = std::get_if<If>(stmt.get())) {
+    hoist(loop, ifStmt->condition, hoisted);
+    hoist(loop, ifStmt->thenBranch, hoisted);
+    hoist(loop, ifStmt->elseBranch, hoisted);
+  } else if (Print *print = std::get_if<Print>(stmt.get())) {
+    hoist(loop, print->expr, hoisted);
+  } else if (Return *ret = std::get_if<Return>(stmt.get())) {
+    hoist(loop, ret->value, hoisted);
+  } else if (Var *var = std::get_if<Var>(stmt.get())) {
+    hoist(loop, var->initializer, hoisted);
+  } else if (While *loopStmt = std::get_if<While>(stmt.get())) {
+    hoist(loop, loopStmt->condition, hoisted);
+    hoist(loop, loopStmt->body, hoisted);
+  }
+}
+
+// Analysis
+
+void LoopInvariantMotion::declare(const std::string &name) {
+  if (scopes.empty())
+    return;
+
+  scopes.back()[name] = declDepths.size();
+  declDepths.push_back(scopeDepths.back());
+}
+
+std::optional<size_t>
+LoopInvariantMotion::resolve(const std::optional<size_t> &id,
+                             const std::string &name) {
+  if (!id.has_value() || !interpreter.locals.count(id.value()))
+    return std::nullopt;
+
+  int index = scopes.size() - 1 - interpreter.locals[id.value()];
+  if (index < 0 || !scopes[index].count(name))
+    return std::nullopt;
+
+  size_t decl = scopes[index][name];
+  declOf[id.value()] = decl;
+  return decl;
+}
+
+void LoopInvariantMotion::operator()(Block &stmt) {
+  scopes.push_back({});
+  scopeDepths.push_back(functionDepth);
+
+  analyze(stmt.statements);
+
+  scopes.pop_back();
+  scopeDepths.pop_back();
+}
+
+void LoopInvariantMotion::operator()(Class &stmt) { declare(stmt.name.lexeme); }
+
+void LoopInvariantMotion::operator()(Expression &stmt) { analyze(stmt.expr); }
+
+void LoopInvariantMotion::operator()(Func &stmt) {
+  declare(stmt.name.lexeme);
+
+  functionDepth++;
+  scopes.push_back({});
+  scopeDepths.push_back(functionDepth);
+
+  for (Token &param : stmt.params) {
+    declare(param.lexeme);
+  }
+
+  analyze(stmt.body);
+
+  scopes.pop_back();
+  scopeDepths.pop_back();
+  functionDepth--;
+}
+
+void LoopInvariantMotion::operator()(If &stmt) {
+  analyze(stmt.condition);
+  analyze(stmt.thenBranch);
+
+  if (stmt.elseBranch != nullptr)
+    analyze(stmt.elseBranch);
+}
+
+void LoopInvariantMotion::operator()(Print &stmt) { analyze(stmt.expr); }
+
+void LoopInvariantMotion::operator()(Return &stmt) {
+  if (stmt.value != nullptr)
+    analyze(stmt.value);
+}
+
+void LoopInvariantMotion::operator()(Var &stmt) {
+  declare(stmt.name.lexeme);
+
+  if (stmt.initializer != nullptr)
+    analyze(stmt.initializer);
+}
+
+void LoopInvariantMotion::operator()(While &stmt) {
+  openLoops.push_back(Loop{currentSlot, declDepths.size(), 0, {}});
+
+  analyze(stmt.condition);
+  analyze(stmt.body);
+
+  Loop loop = std::move(openLoops.back());
+  openLoops.pop_back();
+  loop.endDecl = declDepths.size();
+
+  if (!openLoops.empty()) {
+    openLoops.back().assigned.insert(loop.assigned.begin(),
+                                     loop.assigned.end());
+  }
+
+  loops.push_back(std::move(loop));
+}
+
+void LoopInvariantMotion::operator()(Assign &expr) {
+  analyze(expr.value);
+
+  std::optional<size_t> decl = resolve(expr.id, expr.name.lexeme);
+  if (!decl.has_value())
+    return;
+
+  if (declDepths[decl.value()] < functionDepth)
+    capturedWrites.insert(decl.value());
+
+  if (!openLoops.empty())
+    openLoops.back().assigned.insert(decl.value());
+}
+
+void LoopInvariantMotion::operator()(Logical &expr) {
+  analyze(expr.left);
+  analyze(expr.right);
+}
+
+void LoopInvariantMotion::operator()(Binary &expr) {
+  analyze(expr.left);
+  analyze(expr.right);
+}
+
+void LoopInvariantMotion::operator()(Call &expr) {
+  analyze(expr.callee);
+
+  for (std::shared_ptr<Expr> &arg : expr.args) {
+    analyze(arg);
+  }
+}
+
+void LoopInvariantMotion::operator()(Get &expr) { analyze(expr.object); }
+
+void LoopInvariantMotion::operator()(Set &expr) {
+  analyze(expr.object);
+  analyze(expr.value);
+}
+
+void LoopInvariantMotion::operator()(Grouping &expr) {
+  analyze(expr.expression);
+}
+
+void LoopInvariantMotion::operator()(Literal &expr) {}
+
+void LoopInvariantMotion::operator()(Unary &expr) { analyze(expr.right); }
+
+void LoopInvariantMotion::operator()(Variable &expr) {
+  resolve(expr.id, expr.name.lexeme);
+}
+
+void LoopInvariantMotion::operator()(ListLiteral &expr) {
+  for (std::shared_ptr<Expr> &element : expr.elements) {
+    analyze(element);
+  }
+}
+
+void LoopInvariantMotion::operator()(Index &expr) {
+  analyze(expr.object);
+  analyze(expr.index);
+}
+
+void LoopInvariantMotion::operator()(SetIndex &expr) {
+  analyze(expr.object);
+  analyze(expr.index);
+  analyze(expr.value);
+}
+
+void LoopInvariantMotion::analyze(
+    std::vector<std::shared_ptr<Stmt>> &statements) {
+  for (std::shared_ptr<Stmt> &stmt : statements) {
+    analyze(stmt);
+  }
+}
+
+void LoopInvariantMotion::analyze(std::shared_ptr<Stmt> &statement) {
+  currentSlot = &statement;
+  std::visit(*this, *statement);
+}
+
+void LoopInvariantMotion::analyze(std::shared_ptr<Expr> &expr) {
+  std::visit(*this, *expr);
+}
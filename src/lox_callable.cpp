@@ -1,6 +1,10 @@
 #include "lox_callable.hpp"
 #include "environment.hpp"
 #include "expr.hpp"
+#include "jit.hpp"
+#include "memo_cache.hpp"
+#include "metrics.hpp"
+#include "options.hpp"
 #include "stmt.hpp"
 #include "token.hpp"
 #include <ctime>
@@ -8,11 +12,13 @@
 #include <memory>
 #include <variant>
 
+extern Options options;
+
 // LoxCallable
 
 // int LoxCallable::arity() { return 0; }
 //
-// LiteralObject LoxCallable::call(Interpreter interpreter,
+// LiteralObject LoxCallable::call(Interpreter &interpreter,
 //                                 std::vector<LiteralObject> args) {
 //   return std::monostate{};
 // }
@@ -23,7 +29,7 @@
 
 int ClockFunc::arity() { return 0; }
 
-LiteralObject ClockFunc::call(Interpreter interpreter,
+LiteralObject ClockFunc::call(Interpreter &interpreter,
                               std::vector<LiteralObject> args) {
   return static_cast<double>(std::time(nullptr));
 }
@@ -40,17 +46,95 @@ LoxFunc::LoxFunc(std::shared_ptr<Func> funcDeclaration,
 
 int LoxFunc::arity() { return funcDeclaration->params.size(); }
 
-LiteralObject LoxFunc::call(Interpreter interpreter,
+LiteralObject LoxFunc::call(Interpreter &interpreter,
                             std::vector<LiteralObject> args) {
-  std::shared_ptr<Environment> env = std::make_shared<Environment>(closure);
+  MemoCache *memo = funcDeclaration->memo.get();
 
-  for (int i = 0; i < funcDeclaration->params.size(); i++) {
-    env->define(funcDeclaration->params[i].lexeme, args[i]);
+  if (memo != nullptr && MemoCache::isKey(args)) {
+    if (const LiteralObject *cached = memo->find(args))
+      return *cached;
+
+    std::vector<LiteralObject> key = args;
+    LiteralObject result = invoke(interpreter, std::move(args));
+    memo->insert(std::move(key), result);
+    return result;
   }
 
-  interpreter.executeBlock(funcDeclaration->body, env);
+  return invoke(interpreter, std::move(args));
+}
+
+LiteralObject LoxFunc::invoke(Interpreter &interpreter,
+                              std::vector<LiteralObject> args) {
+  JitFunction *jit = funcDeclaration->jit.get();
+
+  if (jit == nullptr || Jit::interpreting > 0)
+    return walk(interpreter, std::move(args));
+
+  LiteralObject result{};
+  Jit::Outcome outcome =
+      Jit::run(*jit, *funcDeclaration, interpreter, args, result);
+
+  if (outcome == Jit::Outcome::NOT_RUN)
+    return walk(interpreter, std::move(args));
+
+  // Only outermost native calls are verified; the calls they make are
+  // covered by that, and checking each would redo the work at every level.
+  if (outcome == Jit::Outcome::RAN && (!options.jitVerify || Jit::nested()))
+    return result;
+
+  // Rerun without native code below, where a bailout would likely recur.
+  LiteralObject walked{};
+  Jit::interpreting++;
+
+  try {
+    walked = walk(interpreter, args);
+  } catch (...) {
+    Jit::interpreting--;
+    throw;
+  }
+
+  Jit::interpreting--;
+
+  if (outcome == Jit::Outcome::RAN)
+    Jit::verify(*jit, args, result, walked);
 
-  return std::monostate{};
+  return walked;
+}
+
+LiteralObject LoxFunc::walk(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxCallable> tailCallee{};
+  LoxFunc *function = this;
+  std::shared_ptr<Environment> env = std::make_shared<Environment>(closure);
+
+  while (true) {
+    const std::vector<Token> &params = function->funcDeclaration->params;
+
+    for (int i = 0; i < params.size(); i++) {
+      env->define(params[i].lexeme, std::move(args[i]));
+    }
+
+    Completion completion =
+        interpreter.executeBlock(function->funcDeclaration->body, env);
+
+    if (completion == Completion::NORMAL)
+      return std::monostate{};
+
+    if (completion == Completion::RETURN)
+      return std::move(interpreter.returnValue);
+
+    // A tail call runs in this frame instead of nesting another one, and
+    // reuses the environment too unless a closure has captured it.
+    tailCallee = std::move(interpreter.tailCallee);
+    function = static_cast<LoxFunc *>(tailCallee.get());
+    args.swap(interpreter.tailArgs);
+
+    if (env.use_count() == 1) {
+      env->reset(function->closure);
+    } else {
+      env = std::make_shared<Environment>(function->closure);
+    }
+  }
 }
 
 std::string LoxFunc::toString() const {
@@ -63,7 +147,7 @@ LoxClass::LoxClass(std::string name) { this->name = name; }
 
 int LoxClass::arity() { return 0; }
 
-LiteralObject LoxClass::call(Interpreter interpreter,
+LiteralObject LoxClass::call(Interpreter &interpreter,
                              std::vector<LiteralObject> args) {
   std::shared_ptr<LoxInstance> instance = std::make_shared<LoxInstance>(this);
   return instance;
@@ -73,14 +157,23 @@ std::string LoxClass::toString() const { return this->name; }
 
 // LoxInstance
 
-LoxInstance::LoxInstance(LoxClass *klass) { this->klass = klass; }
+LoxInstance::LoxInstance(LoxClass *klass) {
+  this->klass = klass;
+  Metrics::add(Metrics::INSTANCES);
+  Metrics::add(Metrics::LIVE_INSTANCES);
+}
+
+LoxInstance::~LoxInstance() { Metrics::add(Metrics::LIVE_INSTANCES, -1); }
 
 std::string LoxInstance::toString() const {
   return "<" + klass->name + " instance>";
 }
 
-LiteralObject LoxInstance::get(Token name) { return fields[name.lexeme]; }
+LiteralObject LoxInstance::get(const Token &name) {
+  return fields[name.lexeme];
+}
 
-void LoxInstance::set(Token name, LiteralObject value) {
+void LoxInstance::set(const Token &name, LiteralObject value) {
+  Metrics::add(Metrics::FIELD_WRITES);
   fields[name.lexeme] = value;
 }
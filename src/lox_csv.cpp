@@ -0,0 +1,138 @@
+#include "lox_csv.hpp"
+#include "lox_list.hpp"
+#include "lox_reader.hpp"
+#include "lox_string.hpp"
+#include "runtime_error.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <variant>
+
+static LiteralObject unquotedField(std::string_view text) {
+  char first = text.empty() ? '\0' : text[0];
+
+  // from_chars would also take "inf" and "nan", which are words here.
+  if ((first >= '0' && first <= '9') || first == '-' || first == '.') {
+    double value = 0;
+    const char *end = text.data() + text.size();
+    auto [parsed, error] = std::from_chars(text.data(), end, value);
+
+    if (error == std::errc() && parsed == end)
+      return value;
+  }
+
+  return std::make_shared<LoxString>(std::string(text));
+}
+
+// Splits a record into fields. scratch is reused to unescape quoted fields.
+static std::shared_ptr<LoxList> parseRecord(std::string_view record,
+                                            std::string &scratch) {
+  if (!record.empty() && record.back() == '\r')
+    record.remove_suffix(1);
+
+  auto row = std::make_shared<LoxList>();
+  size_t i = 0;
+
+  while (true) {
+    if (i < record.size() && record[i] == '"') {
+      scratch.clear();
+      i++;
+
+      while (i < record.size()) {
+        const char *quote = static_cast<const char *>(
+            std::memchr(record.data() + i, '"', record.size() - i));
+        size_t stop = quote != nullptr ? quote - record.data() : record.size();
+
+        scratch.append(record.data() + i, stop - i);
+        i = stop + 1;
+
+        if (i < record.size() && record[i] == '"') {
+          scratch += '"';
+          i++;
+        } else {
+          break;
+        }
+      }
+
+      // Anything between the closing quote and the comma is kept as is.
+      size_t comma = std::min(record.find(',', i), record.size());
+
+      if (i < comma)
+        scratch.append(record.substr(i, comma - i));
+
+      row->elements.push_back(std::make_shared<LoxString>(scratch));
+      i = comma;
+    } else {
+      size_t comma = std::min(record.find(',', i), record.size());
+      row->elements.push_back(unquotedField(record.substr(i, comma - i)));
+      i = comma;
+    }
+
+    if (i >= record.size())
+      return row;
+
+    i++;
+  }
+}
+
+// The next non-blank record, or null at the end of the input.
+static std::shared_ptr<LoxList> nextRow(LoxReader &reader,
+                                        std::string &scratch) {
+  while (true) {
+    std::string_view record = reader.readRecord();
+
+    if (record.data() == nullptr)
+      return nullptr;
+
+    if (!record.empty() && record != "\r")
+      return parseRecord(record, scratch);
+  }
+}
+
+// CsvRowFunc
+
+int CsvRowFunc::arity() { return 1; }
+
+LiteralObject CsvRowFunc::call(Interpreter &interpreter,
+                               std::vector<LiteralObject> args) {
+  std::string scratch{};
+  std::shared_ptr<LoxList> row =
+      nextRow(*checkReader(args[0], "csvRow"), scratch);
+
+  if (row == nullptr)
+    return std::monostate{};
+
+  return row;
+}
+
+std::string CsvRowFunc::toString() const { return "<native fn>"; }
+
+// CsvEachFunc
+
+int CsvEachFunc::arity() { return 2; }
+
+LiteralObject CsvEachFunc::call(Interpreter &interpreter,
+                                std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxReader> reader = checkReader(args[0], "csvEach");
+
+  if (!std::holds_alternative<std::shared_ptr<LoxCallable>>(args[1]) ||
+      std::get<std::shared_ptr<LoxCallable>>(args[1])->arity() != 1)
+    throw new NativeError(
+        "Second argument to 'csvEach' must be a function of one argument.");
+
+  std::shared_ptr<LoxCallable> function =
+      std::get<std::shared_ptr<LoxCallable>>(args[1]);
+  std::string scratch{};
+  double rows = 0;
+
+  while (std::shared_ptr<LoxList> row = nextRow(*reader, scratch)) {
+    function->call(interpreter, {row});
+    rows++;
+  }
+
+  return rows;
+}
+
+std::string CsvEachFunc::toString() const { return "<native fn>"; }
@@ -0,0 +1,250 @@
+#include "lox_float64_array.hpp"
+#include "float64_kernels.hpp"
+#include "lox_list.hpp"
+#include "runtime_error.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <variant>
+
+// LoxFloat64Array
+
+LoxFloat64Array::LoxFloat64Array(size_t size) : size(size) {
+  if (size > MAX_SIZE)
+    throw new NativeError("Float64Array size is too large.");
+
+  // aligned_alloc wants a multiple of the alignment, and at least one byte.
+  size_t bytes = (size * sizeof(double) + ALIGNMENT - 1) / ALIGNMENT *
+                 ALIGNMENT;
+  data = static_cast<double *>(
+      std::aligned_alloc(ALIGNMENT, bytes > 0 ? bytes : ALIGNMENT));
+
+  if (data == nullptr)
+    throw new NativeError("Not enough memory for a Float64Array of " +
+                          std::to_string(size) + " elements.");
+}
+
+LoxFloat64Array::~LoxFloat64Array() { std::free(data); }
+
+std::string LoxFloat64Array::toString() const {
+  return "<Float64Array " + std::to_string(size) + ">";
+}
+
+std::shared_ptr<LoxFloat64Array> asFloat64Array(const LiteralObject &obj) {
+  if (auto *object = std::get_if<std::shared_ptr<NativeObject>>(&obj))
+    return std::dynamic_pointer_cast<LoxFloat64Array>(*object);
+
+  return nullptr;
+}
+
+static std::shared_ptr<LoxFloat64Array> checkArray(const LiteralObject &obj,
+                                                   std::string fnName) {
+  std::shared_ptr<LoxFloat64Array> array = asFloat64Array(obj);
+
+  if (array == nullptr)
+    throw new NativeError("Arguments to '" + fnName +
+                          "' must be Float64Arrays.");
+
+  return array;
+}
+
+static void checkSameSize(const LoxFloat64Array &a,
+                          const LoxFloat64Array &b) {
+  if (a.size != b.size)
+    throw new NativeError("Float64Arrays must have the same size.");
+}
+
+static LiteralObject wrap(std::shared_ptr<LoxFloat64Array> array) {
+  return std::shared_ptr<NativeObject>(std::move(array));
+}
+
+// Float64ArrayFunc
+
+int Float64ArrayFunc::arity() { return 1; }
+
+LiteralObject Float64ArrayFunc::call(Interpreter &interpreter,
+                                     std::vector<LiteralObject> args) {
+  if (auto *list = std::get_if<std::shared_ptr<LoxList>>(&args[0])) {
+    const std::vector<LiteralObject> &elements = (*list)->elements;
+    auto array = std::make_shared<LoxFloat64Array>(elements.size());
+
+    for (size_t i = 0; i < elements.size(); i++) {
+      if (!std::holds_alternative<double>(elements[i]))
+        throw new NativeError("Float64Array elements must be numbers.");
+
+      array->data[i] = std::get<double>(elements[i]);
+    }
+
+    return wrap(std::move(array));
+  }
+
+  const double *size = std::get_if<double>(&args[0]);
+
+  if (size == nullptr || *size != std::floor(*size) || *size < 0)
+    throw new NativeError(
+        "Argument to 'Float64Array' must be a size or a list of numbers.");
+
+  // Compared as doubles, before the conversion, which past SIZE_MAX would
+  // be undefined.
+  if (*size > static_cast<double>(LoxFloat64Array::MAX_SIZE))
+    throw new NativeError("Float64Array size is too large.");
+
+  auto array = std::make_shared<LoxFloat64Array>(static_cast<size_t>(*size));
+  std::fill(array->data, array->data + array->size, 0.0);
+  return wrap(std::move(array));
+}
+
+std::string Float64ArrayFunc::toString() const { return "<native fn>"; }
+
+// AddFunc
+
+int AddFunc::arity() { return 2; }
+
+LiteralObject AddFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxFloat64Array> a = checkArray(args[0], "add");
+  std::shared_ptr<LoxFloat64Array> b = checkArray(args[1], "add");
+  checkSameSize(*a, *b);
+
+  auto result = std::make_shared<LoxFloat64Array>(a->size);
+  float64Kernels().add(a->data, b->data, result->data, a->size);
+  return wrap(std::move(result));
+}
+
+std::string AddFunc::toString() const { return "<native fn>"; }
+
+// MulFunc
+
+int MulFunc::arity() { return 2; }
+
+LiteralObject MulFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxFloat64Array> a = checkArray(args[0], "mul");
+  std::shared_ptr<LoxFloat64Array> b = checkArray(args[1], "mul");
+  checkSameSize(*a, *b);
+
+  auto result = std::make_shared<LoxFloat64Array>(a->size);
+  float64Kernels().mul(a->data, b->data, result->data, a->size);
+  return wrap(std::move(result));
+}
+
+std::string MulFunc::toString() const { return "<native fn>"; }
+
+// FmaFunc
+
+int FmaFunc::arity() { return 3; }
+
+LiteralObject FmaFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxFloat64Array> a = checkArray(args[0], "fma");
+  std::shared_ptr<LoxFloat64Array> b = checkArray(args[1], "fma");
+  std::shared_ptr<LoxFloat64Array> c = checkArray(args[2], "fma");
+  checkSameSize(*a, *b);
+  checkSameSize(*a, *c);
+
+  auto result = std::make_shared<LoxFloat64Array>(a->size);
+  float64Kernels().fma(a->data, b->data, c->data, result->data, a->size);
+  return wrap(std::move(result));
+}
+
+std::string FmaFunc::toString() const { return "<native fn>"; }
+
+// ScaleFunc
+
+int ScaleFunc::arity() { return 2; }
+
+LiteralObject ScaleFunc::call(Interpreter &interpreter,
+                              std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxFloat64Array> a = checkArray(args[0], "scale");
+
+  if (!std::holds_alternative<double>(args[1]))
+    throw new NativeError("Scale factor must be a number.");
+
+  auto result = std::make_shared<LoxFloat64Array>(a->size);
+  float64Kernels().scale(a->data, std::get<double>(args[1]), result->data,
+                         a->size);
+  return wrap(std::move(result));
+}
+
+std::string ScaleFunc::toString() const { return "<native fn>"; }
+
+// SqrtFunc
+
+int SqrtFunc::arity() { return 1; }
+
+LiteralObject SqrtFunc::call(Interpreter &interpreter,
+                             std::vector<LiteralObject> args) {
+  if (std::holds_alternative<double>(args[0]))
+    return std::sqrt(std::get<double>(args[0]));
+
+  std::shared_ptr<LoxFloat64Array> a = asFloat64Array(args[0]);
+
+  if (a == nullptr)
+    throw new NativeError(
+        "Argument to 'sqrt' must be a number or a Float64Array.");
+
+  auto result = std::make_shared<LoxFloat64Array>(a->size);
+  float64Kernels().sqrt(a->data, result->data, a->size);
+  return wrap(std::move(result));
+}
+
+std::string SqrtFunc::toString() const { return "<native fn>"; }
+
+// SumFunc
+
+int SumFunc::arity() { return 1; }
+
+LiteralObject SumFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxFloat64Array> a = checkArray(args[0], "sum");
+  return float64Kernels().sum(a->data, a->size);
+}
+
+std::string SumFunc::toString() const { return "<native fn>"; }
+
+// DotFunc
+
+int DotFunc::arity() { return 2; }
+
+LiteralObject DotFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxFloat64Array> a = checkArray(args[0], "dot");
+  std::shared_ptr<LoxFloat64Array> b = checkArray(args[1], "dot");
+  checkSameSize(*a, *b);
+
+  return float64Kernels().dot(a->data, b->data, a->size);
+}
+
+std::string DotFunc::toString() const { return "<native fn>"; }
+
+// MinFunc
+
+int MinFunc::arity() { return 1; }
+
+LiteralObject MinFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxFloat64Array> a = checkArray(args[0], "min");
+
+  if (a->size == 0)
+    return std::monostate{};
+
+  return float64Kernels().min(a->data, a->size);
+}
+
+std::string MinFunc::toString() const { return "<native fn>"; }
+
+// MaxFunc
+
+int MaxFunc::arity() { return 1; }
+
+LiteralObject MaxFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxFloat64Array> a = checkArray(args[0], "max");
+
+  if (a->size == 0)
+    return std::monostate{};
+
+  return float64Kernels().max(a->data, a->size);
+}
+
+std::string MaxFunc::toString() const { return "<native fn>"; }
@@ -0,0 +1,594 @@
+#include "lox_json.hpp"
+#include "lox_list.hpp"
+#include "lox_map.hpp"
+#include "lox_string.hpp"
+#include "number_format.hpp"
+#include "runtime_error.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Deeper documents (or cyclic values) are rejected rather than allowed to
+// overflow the native stack.
+constexpr size_t MAX_DEPTH = 512;
+
+// Returns the first byte from p that ends a run of plain string
+// characters: a quote, a backslash or a control character. With SSE2 it
+// checks 16 bytes per step.
+static const char *scanString(const char *p, const char *end) {
+#ifdef __SSE2__
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control = _mm_set1_epi8(0x1f);
+
+  while (end - p >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                     _mm_cmpeq_epi8(chunk, backslash)),
+        _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+    int mask = _mm_movemask_epi8(special);
+
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+
+    p += 16;
+  }
+#endif
+
+  while (p < end && *p != '"' && *p != '\\' &&
+         static_cast<unsigned char>(*p) >= 0x20) {
+    p++;
+  }
+
+  return p;
+}
+
+static void appendUtf8(std::string &out, uint32_t code) {
+  if (code < 0x80) {
+    out += static_cast<char>(code);
+  } else if (code < 0x800) {
+    out += static_cast<char>(0xc0 | (code >> 6));
+    out += static_cast<char>(0x80 | (code & 0x3f));
+  } else if (code < 0x10000) {
+    out += static_cast<char>(0xe0 | (code >> 12));
+    out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+    out += static_cast<char>(0x80 | (code & 0x3f));
+  } else {
+    out += static_cast<char>(0xf0 | (code >> 18));
+    out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+    out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+    out += static_cast<char>(0x80 | (code & 0x3f));
+  }
+}
+
+// Recursive descent over the document in one pass. Object keys are
+// interned per document, so the thousands of records in a typical array
+// share one string (and its cached hash) per distinct key.
+class JsonParser {
+private:
+  const char *start;
+  const char *current;
+  const char *end;
+  std::unordered_map<std::string_view, std::shared_ptr<LoxString>> keys{};
+  std::string scratch{};
+
+  // Members of the objects being parsed, innermost last, so each map is
+  // created at its final size.
+  std::vector<std::pair<std::shared_ptr<LoxString>, LiteralObject>>
+      members{};
+
+  [[noreturn]] void error(const std::string &message) {
+    throw new NativeError("Invalid JSON at offset " +
+                          std::to_string(current - start) + ": " + message);
+  }
+
+  void skipWhitespace() {
+    while (current < end && (*current == ' ' || *current == '\n' ||
+                             *current == '\r' || *current == '\t')) {
+      current++;
+    }
+  }
+
+  bool match(std::string_view word) {
+    if (static_cast<size_t>(end - current) < word.size() ||
+        std::string_view(current, word.size()) != word)
+      return false;
+
+    current += word.size();
+    return true;
+  }
+
+  void expect(char c) {
+    skipWhitespace();
+
+    if (current == end || *current != c)
+      error(std::string("expected '") + c + "'.");
+
+    current++;
+  }
+
+  uint32_t hexQuad() {
+    uint32_t code = 0;
+
+    if (end - current < 4)
+      error("incomplete \\u escape.");
+
+    for (int i = 0; i < 4; i++) {
+      char c = *current++;
+      code <<= 4;
+
+      if (c >= '0' && c <= '9')
+        code |= c - '0';
+      else if (c >= 'a' && c <= 'f')
+        code |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        code |= c - 'A' + 10;
+      else
+        error("invalid \\u escape.");
+    }
+
+    return code;
+  }
+
+  void escape(std::string &out) {
+    if (current == end)
+      error("unterminated string.");
+
+    switch (*current++) {
+    case '"':
+      out += '"';
+      break;
+    case '\\':
+      out += '\\';
+      break;
+    case '/':
+      out += '/';
+      break;
+    case 'b':
+      out += '\b';
+      break;
+    case 'f':
+      out += '\f';
+      break;
+    case 'n':
+      out += '\n';
+      break;
+    case 'r':
+      out += '\r';
+      break;
+    case 't':
+      out += '\t';
+      break;
+    case 'u': {
+      uint32_t code = hexQuad();
+
+      if (code >= 0xd800 && code < 0xdc00 && match("\\u")) {
+        uint32_t low = hexQuad();
+
+        if (low >= 0xdc00 && low < 0xe000) {
+          code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+        } else {
+          appendUtf8(out, code);
+          code = low;
+        }
+      }
+
+      appendUtf8(out, code);
+      break;
+    }
+    default:
+      current--;
+      error("invalid escape.");
+    }
+  }
+
+  // Parses the string after its opening quote. Returns the raw bytes when
+  // there are no escapes; otherwise the decoded text is left in scratch and
+  // the result's data is null.
+  std::string_view string() {
+    const char *begin = current;
+    current = scanString(current, end);
+
+    if (current < end && *current == '"')
+      return std::string_view(begin, current++ - begin);
+
+    scratch.assign(begin, current);
+
+    while (true) {
+      if (current == end)
+        error("unterminated string.");
+
+      char c = *current;
+
+      if (c == '"') {
+        current++;
+        return std::string_view{};
+      }
+
+      if (static_cast<unsigned char>(c) < 0x20)
+        error("control character in string.");
+
+      current++;
+      escape(scratch);
+
+      const char *run = current;
+      current = scanString(current, end);
+      scratch.append(run, current);
+    }
+  }
+
+  std::shared_ptr<LoxString> key() {
+    std::string_view raw = string();
+
+    if (raw.data() == nullptr)
+      return std::make_shared<LoxString>(scratch);
+
+    auto interned = keys.find(raw);
+
+    if (interned != keys.end())
+      return interned->second;
+
+    auto key = std::make_shared<LoxString>(std::string(raw));
+    keys.emplace(raw, key);
+    return key;
+  }
+
+  double number() {
+    const char *begin = current;
+    bool negative = current < end && *current == '-';
+
+    if (negative)
+      current++;
+
+    // Where the first significant digit is, as a power of ten, to tell
+    // whether a number out of range is too large or too small.
+    long long magnitude = 0;
+
+    if (current < end && *current == '0') {
+      current++;
+    } else if (current < end && *current >= '1' && *current <= '9') {
+      while (current < end && *current >= '0' && *current <= '9') {
+        current++;
+        magnitude++;
+      }
+    } else {
+      error("expected a value.");
+    }
+
+    if (current < end && *current == '.') {
+      if (++current == end || *current < '0' || *current > '9')
+        error("expected a digit.");
+
+      bool leading = magnitude == 0;
+
+      while (current < end && *current >= '0' && *current <= '9') {
+        leading = leading && *current == '0';
+        magnitude -= leading;
+        current++;
+      }
+    }
+
+    if (current < end && (*current == 'e' || *current == 'E')) {
+      current++;
+      bool negativeExponent = current < end && *current == '-';
+
+      if (current < end && (*current == '+' || *current == '-'))
+        current++;
+
+      if (current == end || *current < '0' || *current > '9')
+        error("expected a digit.");
+
+      long long exponent = 0;
+
+      while (current < end && *current >= '0' && *current <= '9') {
+        exponent = std::min(exponent * 10 + (*current - '0'), 1000000LL);
+        current++;
+      }
+
+      magnitude += negativeExponent ? -exponent : exponent;
+    }
+
+    double value = 0;
+
+    if (std::from_chars(begin, current, value).ec ==
+        std::errc::result_out_of_range) {
+      value = magnitude > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+      value = negative ? -value : value;
+    }
+
+    return value;
+  }
+
+  LiteralObject array(size_t depth) {
+    auto list = std::make_shared<LoxList>();
+    skipWhitespace();
+
+    if (current < end && *current == ']') {
+      current++;
+      return list;
+    }
+
+    while (true) {
+      list->elements.push_back(value(depth));
+      skipWhitespace();
+
+      if (current < end && *current == ',') {
+        current++;
+        continue;
+      }
+
+      expect(']');
+      return list;
+    }
+  }
+
+  LiteralObject object(size_t depth) {
+    auto map = std::make_shared<LoxMap>();
+    skipWhitespace();
+
+    if (current < end && *current == '}') {
+      current++;
+      return map;
+    }
+
+    size_t first = members.size();
+
+    while (true) {
+      expect('"');
+      std::shared_ptr<LoxString> name = key();
+      expect(':');
+      LiteralObject member = value(depth);
+      members.emplace_back(std::move(name), std::move(member));
+      skipWhitespace();
+
+      if (current < end && *current == ',') {
+        current++;
+        continue;
+      }
+
+      expect('}');
+      break;
+    }
+
+    map->reserve(members.size() - first);
+
+    for (size_t i = first; i < members.size(); i++) {
+      map->set(std::move(members[i].first), std::move(members[i].second));
+    }
+
+    members.resize(first);
+    return map;
+  }
+
+public:
+  JsonParser(std::string_view text)
+      : start(text.data()), current(text.data()),
+        end(text.data() + text.size()) {}
+
+  LiteralObject value(size_t depth) {
+    if (depth == MAX_DEPTH)
+      error("nested too deeply.");
+
+    skipWhitespace();
+
+    if (current == end)
+      error("expected a value.");
+
+    switch (*current) {
+    case '{':
+      current++;
+      return object(depth + 1);
+    case '[':
+      current++;
+      return array(depth + 1);
+    case '"': {
+      current++;
+      std::string_view raw = string();
+      return std::make_shared<LoxString>(
+          raw.data() == nullptr ? scratch : std::string(raw));
+    }
+    case 't':
+      if (match("true"))
+        return true;
+      break;
+    case 'f':
+      if (match("false"))
+        return false;
+      break;
+    case 'n':
+      if (match("null"))
+        return std::monostate{};
+      break;
+    default:
+      return number();
+    }
+
+    error("expected a value.");
+  }
+
+  LiteralObject document() {
+    LiteralObject result = value(0);
+    skipWhitespace();
+
+    if (current != end)
+      error("unexpected text after the document.");
+
+    return result;
+  }
+};
+
+// Appends everything to one buffer, reserved up front and grown by
+// doubling, so encoding a large value does a handful of allocations.
+class JsonWriter {
+public:
+  std::string out{};
+
+  void string(const std::string &text) {
+    static const char hex[] = "0123456789abcdef";
+    const char *p = text.data();
+    const char *end = p + text.size();
+
+    out += '"';
+
+    while (true) {
+      const char *run = scanString(p, end);
+      out.append(p, run);
+
+      if (run == end)
+        break;
+
+      unsigned char c = *run;
+      p = run + 1;
+
+      switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        out += "\\u00";
+        out += hex[c >> 4];
+        out += hex[c & 0xf];
+      }
+    }
+
+    out += '"';
+  }
+
+  void number(double value) {
+    // JSON has no NaN or infinities; JavaScript writes them as null.
+    if (!std::isfinite(value)) {
+      out += "null";
+      return;
+    }
+
+    char buffer[NUMBER_BUFFER_SIZE];
+    out.append(buffer, formatNumber(value, buffer));
+  }
+
+  void key(const LiteralObject &key) {
+    if (auto *text = std::get_if<std::shared_ptr<LoxString>>(&key)) {
+      string((*text)->str());
+      return;
+    }
+
+    // Number and boolean map keys become strings, as object keys must be.
+    out += '"';
+
+    if (auto *num = std::get_if<double>(&key))
+      number(*num);
+    else
+      out += std::get<bool>(key) ? "true" : "false";
+
+    out += '"';
+  }
+
+  void value(const LiteralObject &value, size_t depth) {
+    if (depth == MAX_DEPTH)
+      throw new NativeError("Value is nested too deeply (or contains itself) "
+                            "to convert to JSON.");
+
+    if (std::holds_alternative<std::monostate>(value)) {
+      out += "null";
+    } else if (auto *boolean = std::get_if<bool>(&value)) {
+      out += *boolean ? "true" : "false";
+    } else if (auto *num = std::get_if<double>(&value)) {
+      number(*num);
+    } else if (auto *text = std::get_if<std::shared_ptr<LoxString>>(&value)) {
+      string((*text)->str());
+    } else if (auto *list = std::get_if<std::shared_ptr<LoxList>>(&value)) {
+      out += '[';
+
+      for (size_t i = 0; i < (*list)->elements.size(); i++) {
+        if (i > 0)
+          out += ',';
+        this->value((*list)->elements[i], depth + 1);
+      }
+
+      out += ']';
+    } else if (auto *map = std::get_if<std::shared_ptr<LoxMap>>(&value)) {
+      std::vector<LiteralObject> keys = (*map)->keys();
+      std::vector<LiteralObject> values = (*map)->values();
+      out += '{';
+
+      for (size_t i = 0; i < keys.size(); i++) {
+        if (i > 0)
+          out += ',';
+        key(keys[i]);
+        out += ':';
+        this->value(values[i], depth + 1);
+      }
+
+      out += '}';
+    } else if (auto *instance =
+                   std::get_if<std::shared_ptr<LoxInstance>>(&value)) {
+      bool first = true;
+      out += '{';
+
+      for (const auto &[name, field] : (*instance)->fields) {
+        if (!first)
+          out += ',';
+        first = false;
+        string(name);
+        out += ':';
+        this->value(field, depth + 1);
+      }
+
+      out += '}';
+    } else {
+      throw new NativeError("Can't convert " +
+                            std::visit(StringifyLiteralVisitor{}, value) +
+                            " to JSON.");
+    }
+  }
+};
+
+// JsonParseFunc
+
+int JsonParseFunc::arity() { return 1; }
+
+LiteralObject JsonParseFunc::call(Interpreter &interpreter,
+                                  std::vector<LiteralObject> args) {
+  if (!std::holds_alternative<std::shared_ptr<LoxString>>(args[0]))
+    throw new NativeError("Argument to 'jsonParse' must be a string.");
+
+  return JsonParser(std::get<std::shared_ptr<LoxString>>(args[0])->str())
+      .document();
+}
+
+std::string JsonParseFunc::toString() const { return "<native fn>"; }
+
+// JsonStringifyFunc
+
+int JsonStringifyFunc::arity() { return 1; }
+
+LiteralObject JsonStringifyFunc::call(Interpreter &interpreter,
+                                      std::vector<LiteralObject> args) {
+  JsonWriter writer{};
+  writer.out.reserve(4096);
+  writer.value(args[0], 0);
+  return std::make_shared<LoxString>(std::move(writer.out));
+}
+
+std::string JsonStringifyFunc::toString() const { return "<native fn>"; }
@@ -0,0 +1,93 @@
+#include "lox_list.hpp"
+#include "lox_float64_array.hpp"
+#include "lox_map.hpp"
+#include "lox_mapping.hpp"
+#include "lox_string.hpp"
+#include "runtime_error.hpp"
+#include "token.hpp"
+#include <memory>
+#include <variant>
+
+// LoxList
+
+LoxList::LoxList(std::vector<LiteralObject> elements)
+    : elements(std::move(elements)) {}
+
+std::string LoxList::toString() const {
+  std::string str = "[";
+
+  for (size_t i = 0; i < elements.size(); i++) {
+    if (i > 0)
+      str += ", ";
+    str += std::visit(StringifyLiteralVisitor{}, elements[i]);
+  }
+
+  return str + "]";
+}
+
+std::shared_ptr<LoxList> checkList(LiteralObject obj, std::string fnName) {
+  if (!std::holds_alternative<std::shared_ptr<LoxList>>(obj))
+    throw new NativeError("Argument to '" + fnName + "' must be a list.");
+  return std::get<std::shared_ptr<LoxList>>(obj);
+}
+
+// LenFunc
+
+int LenFunc::arity() { return 1; }
+
+LiteralObject LenFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  if (std::holds_alternative<std::shared_ptr<LoxMap>>(args[0]))
+    return static_cast<double>(
+        std::get<std::shared_ptr<LoxMap>>(args[0])->size());
+
+  if (std::holds_alternative<std::shared_ptr<LoxString>>(args[0]))
+    return static_cast<double>(
+        std::get<std::shared_ptr<LoxString>>(args[0])->size());
+
+  if (std::shared_ptr<LoxFloat64Array> array = asFloat64Array(args[0]))
+    return static_cast<double>(array->size);
+
+  if (std::holds_alternative<std::shared_ptr<NativeObject>>(args[0]))
+    return static_cast<double>(checkView(args[0], "len")->length);
+
+  if (!std::holds_alternative<std::shared_ptr<LoxList>>(args[0]))
+    throw new NativeError("Argument to 'len' must be a list, map, string, "
+                          "view or Float64Array.");
+
+  return static_cast<double>(
+      std::get<std::shared_ptr<LoxList>>(args[0])->elements.size());
+}
+
+std::string LenFunc::toString() const { return "<native fn>"; }
+
+// PushFunc
+
+int PushFunc::arity() { return 2; }
+
+LiteralObject PushFunc::call(Interpreter &interpreter,
+                             std::vector<LiteralObject> args) {
+  checkList(args[0], "push")->elements.push_back(std::move(args[1]));
+  return std::monostate{};
+}
+
+std::string PushFunc::toString() const { return "<native fn>"; }
+
+// PopFunc
+
+int PopFunc::arity() { return 1; }
+
+LiteralObject PopFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxList> list = checkList(args[0], "pop");
+
+  if (list->elements.empty())
+    throw new NativeError("Can't pop from an empty list.");
+
+  LiteralObject last = std::move(list->elements.back());
+  list->elements.pop_back();
+
+  return last;
+}
+
+std::string PopFunc::toString() const { return "<native fn>"; }
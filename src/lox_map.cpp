@@ -0,0 +1,319 @@
+#include "lox_map.hpp"
+#include "lox_list.hpp"
+#include "lox_string.hpp"
+#include "runtime_error.hpp"
+#include "token.hpp"
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <variant>
+
+uint64_t mixHash(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+// LoxMap
+
+bool LoxMap::isValidKey(const LiteralObject &key) {
+  if (std::holds_alternative<double>(key))
+    return !std::isnan(std::get<double>(key));
+
+  return std::holds_alternative<std::shared_ptr<LoxString>>(key) ||
+         std::holds_alternative<bool>(key);
+}
+
+uint64_t LoxMap::hashKey(const LiteralObject &key) {
+  uint64_t hash = 0;
+
+  if (std::holds_alternative<double>(key)) {
+    // -0.0 == 0.0, so both must land in the same bucket.
+    double num = std::get<double>(key) == 0 ? 0.0 : std::get<double>(key);
+    std::memcpy(&hash, &num, sizeof(hash));
+    hash = mixHash(hash);
+  } else if (std::holds_alternative<std::shared_ptr<LoxString>>(key)) {
+    hash = mixHash(std::get<std::shared_ptr<LoxString>>(key)->hash());
+  } else if (std::holds_alternative<bool>(key)) {
+    hash = mixHash(std::get<bool>(key) ? 3 : 2);
+  }
+
+  // The two lowest values mark empty and deleted slots.
+  return hash <= TOMBSTONE ? hash + 2 : hash;
+}
+
+bool LoxMap::keysEqual(const LiteralObject &a, const LiteralObject &b) {
+  return isEqual(a, b);
+}
+
+LoxMap::Slot *LoxMap::findIn(std::vector<Slot> &table,
+                             const LiteralObject &key, uint64_t hash) {
+  if (table.empty())
+    return nullptr;
+
+  size_t mask = table.size() - 1;
+
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    Slot &slot = table[i];
+
+    if (slot.hash == EMPTY)
+      return nullptr;
+
+    if (slot.hash == hash && keysEqual(slot.key, key))
+      return &slot;
+  }
+}
+
+void LoxMap::insertNew(uint64_t hash, LiteralObject key, LiteralObject value) {
+  size_t mask = slots.size() - 1;
+  size_t i = hash & mask;
+
+  while (slots[i].hash > TOMBSTONE) {
+    i = (i + 1) & mask;
+  }
+
+  if (slots[i].hash == TOMBSTONE)
+    tombstones--;
+
+  slots[i].hash = hash;
+  slots[i].key = std::move(key);
+  slots[i].value = std::move(value);
+}
+
+void LoxMap::grow() {
+  // Finish any resize still in flight before starting another one.
+  migrate(oldSlots.size());
+
+  size_t live = count;
+  size_t capacity = slots.empty() ? 8 : slots.size();
+
+  // Only double when the table is genuinely full; a table clogged with
+  // tombstones is rebuilt at the same size.
+  if (live * 2 >= capacity)
+    capacity *= 2;
+
+  oldSlots = std::move(slots);
+  slots = std::vector<Slot>(capacity);
+  migrated = 0;
+  oldCount = live;
+  tombstones = 0;
+}
+
+void LoxMap::migrate(size_t steps) {
+  while (steps > 0 && migrated < oldSlots.size()) {
+    Slot &slot = oldSlots[migrated++];
+
+    if (slot.hash > TOMBSTONE) {
+      insertNew(slot.hash, std::move(slot.key), std::move(slot.value));
+      oldCount--;
+
+      // Probes of the old table still pass through it, but must not find
+      // the moved-from entry.
+      slot = Slot{TOMBSTONE};
+    }
+
+    steps--;
+  }
+
+  if (!oldSlots.empty() && migrated == oldSlots.size()) {
+    std::vector<Slot>().swap(oldSlots);
+    migrated = 0;
+  }
+}
+
+void LoxMap::reserve(size_t n) {
+  if (count > 0)
+    return;
+
+  size_t capacity = 8;
+
+  while (n * 4 > capacity * 3) {
+    capacity *= 2;
+  }
+
+  if (capacity > slots.size()) {
+    slots = std::vector<Slot>(capacity);
+    std::vector<Slot>().swap(oldSlots);
+    migrated = 0;
+    oldCount = 0;
+    tombstones = 0;
+  }
+}
+
+LiteralObject *LoxMap::find(const LiteralObject &key) {
+  uint64_t hash = hashKey(key);
+
+  Slot *slot = findIn(slots, key, hash);
+  if (slot == nullptr)
+    slot = findIn(oldSlots, key, hash);
+
+  return slot ? &slot->value : nullptr;
+}
+
+void LoxMap::set(LiteralObject key, LiteralObject value) {
+  uint64_t hash = hashKey(key);
+
+  Slot *slot = findIn(slots, key, hash);
+  if (slot == nullptr)
+    slot = findIn(oldSlots, key, hash);
+
+  if (slot != nullptr) {
+    slot->value = std::move(value);
+    return;
+  }
+
+  // Keep the new table at most 3/4 full, counting tombstones.
+  if ((count - oldCount + tombstones + 1) * 4 > slots.size() * 3)
+    grow();
+
+  insertNew(hash, std::move(key), std::move(value));
+  count++;
+
+  migrate(MIGRATE_STEP);
+}
+
+bool LoxMap::remove(const LiteralObject &key) {
+  uint64_t hash = hashKey(key);
+
+  if (Slot *slot = findIn(slots, key, hash)) {
+    *slot = Slot{TOMBSTONE};
+    tombstones++;
+  } else if (Slot *slot = findIn(oldSlots, key, hash)) {
+    *slot = Slot{TOMBSTONE};
+    oldCount--;
+  } else {
+    return false;
+  }
+
+  count--;
+  migrate(MIGRATE_STEP);
+
+  return true;
+}
+
+size_t LoxMap::size() const { return count; }
+
+size_t LoxMap::capacity() const { return slots.size() + oldSlots.size(); }
+
+std::vector<LiteralObject> LoxMap::keys() const {
+  std::vector<LiteralObject> keys{};
+  keys.reserve(count);
+
+  for (size_t i = migrated; i < oldSlots.size(); i++) {
+    if (oldSlots[i].hash > TOMBSTONE)
+      keys.push_back(oldSlots[i].key);
+  }
+
+  for (const Slot &slot : slots) {
+    if (slot.hash > TOMBSTONE)
+      keys.push_back(slot.key);
+  }
+
+  return keys;
+}
+
+std::vector<LiteralObject> LoxMap::values() const {
+  std::vector<LiteralObject> values{};
+  values.reserve(count);
+
+  for (size_t i = migrated; i < oldSlots.size(); i++) {
+    if (oldSlots[i].hash > TOMBSTONE)
+      values.push_back(oldSlots[i].value);
+  }
+
+  for (const Slot &slot : slots) {
+    if (slot.hash > TOMBSTONE)
+      values.push_back(slot.value);
+  }
+
+  return values;
+}
+
+std::string LoxMap::toString() const {
+  std::vector<LiteralObject> keys = this->keys();
+  std::vector<LiteralObject> values = this->values();
+
+  std::string str = "{";
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (i > 0)
+      str += ", ";
+    str += std::visit(StringifyLiteralVisitor{}, keys[i]) + ": " +
+           std::visit(StringifyLiteralVisitor{}, values[i]);
+  }
+
+  return str + "}";
+}
+
+std::shared_ptr<LoxMap> checkMap(LiteralObject obj, std::string fnName) {
+  if (!std::holds_alternative<std::shared_ptr<LoxMap>>(obj))
+    throw new NativeError("Argument to '" + fnName + "' must be a map.");
+  return std::get<std::shared_ptr<LoxMap>>(obj);
+}
+
+void checkKeyArg(const LiteralObject &key) {
+  if (!LoxMap::isValidKey(key))
+    throw new NativeError("Map keys must be numbers, strings or booleans.");
+}
+
+// MapFunc
+
+int MapFunc::arity() { return 0; }
+
+LiteralObject MapFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  return std::make_shared<LoxMap>();
+}
+
+std::string MapFunc::toString() const { return "<native fn>"; }
+
+// HasFunc
+
+int HasFunc::arity() { return 2; }
+
+LiteralObject HasFunc::call(Interpreter &interpreter,
+                            std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxMap> map = checkMap(args[0], "has");
+  checkKeyArg(args[1]);
+  return map->find(args[1]) != nullptr;
+}
+
+std::string HasFunc::toString() const { return "<native fn>"; }
+
+// RemoveFunc
+
+int RemoveFunc::arity() { return 2; }
+
+LiteralObject RemoveFunc::call(Interpreter &interpreter,
+                               std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxMap> map = checkMap(args[0], "remove");
+  checkKeyArg(args[1]);
+  return map->remove(args[1]);
+}
+
+std::string RemoveFunc::toString() const { return "<native fn>"; }
+
+// KeysFunc
+
+int KeysFunc::arity() { return 1; }
+
+LiteralObject KeysFunc::call(Interpreter &interpreter,
+                             std::vector<LiteralObject> args) {
+  return std::make_shared<LoxList>(checkMap(args[0], "keys")->keys());
+}
+
+std::string KeysFunc::toString() const { return "<native fn>"; }
+
+// ValuesFunc
+
+int ValuesFunc::arity() { return 1; }
+
+LiteralObject ValuesFunc::call(Interpreter &interpreter,
+                               std::vector<LiteralObject> args) {
+  return std::make_shared<LoxList>(checkMap(args[0], "values")->values());
+}
+
+std::string ValuesFunc::toString() const { return "<native fn>"; }
@@ -0,0 +1,235 @@
+#include "lox_mapping.hpp"
+#include "lox_string.hpp"
+#include "runtime_error.hpp"
+#include <cmath>
+#include <unordered_map>
+#include <variant>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// LoxMapping
+
+LoxMapping::LoxMapping(std::string path, const char *data, size_t size)
+    : path(std::move(path)), data(data), size(size) {}
+
+LoxMapping::~LoxMapping() {
+#ifdef __unix__
+  if (data != nullptr)
+    munmap(const_cast<char *>(data), size);
+#endif
+}
+
+std::shared_ptr<LoxMapping> LoxMapping::map(const std::string &path) {
+#ifdef __unix__
+  int fd = ::open(path.c_str(), O_RDONLY);
+
+  if (fd < 0)
+    return nullptr;
+
+  struct stat status;
+
+  if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  size_t size = status.st_size;
+  void *data = nullptr;
+
+  // mmap() rejects an empty range; an empty file is an empty view.
+  if (size > 0)
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  ::close(fd);
+
+  if (data == MAP_FAILED)
+    return nullptr;
+
+  return std::make_shared<LoxMapping>(path, static_cast<const char *>(data),
+                                      size);
+#else
+  return nullptr;
+#endif
+}
+
+// LoxView
+
+LoxView::LoxView(std::shared_ptr<LoxMapping> mapping, size_t offset,
+                 size_t length)
+    : mapping(std::move(mapping)), offset(offset), length(length) {}
+
+std::string_view LoxView::bytes() const {
+  if (length == 0)
+    return std::string_view{};
+
+  return std::string_view(mapping->data + offset, length);
+}
+
+std::string LoxView::toString() const {
+  return "<view " + mapping->path + " " + std::to_string(offset) + ".." +
+         std::to_string(offset + length) + ">";
+}
+
+std::shared_ptr<LoxView> checkView(const LiteralObject &obj,
+                                   std::string fnName) {
+  std::shared_ptr<LoxView> view{};
+
+  if (auto *object = std::get_if<std::shared_ptr<NativeObject>>(&obj))
+    view = std::dynamic_pointer_cast<LoxView>(*object);
+
+  if (view == nullptr)
+    throw new NativeError("Argument to '" + fnName + "' must be a view.");
+
+  return view;
+}
+
+// An integer argument from 0 to limit.
+static size_t checkPosition(const LiteralObject &value, size_t limit,
+                            const std::string &message) {
+  const double *number = std::get_if<double>(&value);
+
+  if (number == nullptr || *number != std::floor(*number) || *number < 0 ||
+      *number > limit)
+    throw new NativeError(message);
+
+  return static_cast<size_t>(*number);
+}
+
+// MmapFileFunc
+
+int MmapFileFunc::arity() { return 1; }
+
+LiteralObject MmapFileFunc::call(Interpreter &interpreter,
+                                 std::vector<LiteralObject> args) {
+  if (!std::holds_alternative<std::shared_ptr<LoxString>>(args[0]))
+    throw new NativeError("Argument to 'mmapFile' must be a string.");
+
+  std::shared_ptr<LoxMapping> mapping =
+      LoxMapping::map(std::get<std::shared_ptr<LoxString>>(args[0])->str());
+
+  if (mapping == nullptr)
+    return std::monostate{};
+
+  size_t size = mapping->size;
+  return std::shared_ptr<NativeObject>(
+      std::make_shared<LoxView>(std::move(mapping), 0, size));
+}
+
+std::string MmapFileFunc::toString() const { return "<native fn>"; }
+
+// SliceFunc
+
+int SliceFunc::arity() { return 3; }
+
+LiteralObject SliceFunc::call(Interpreter &interpreter,
+                              std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxView> view = checkView(args[0], "slice");
+  const std::string message =
+      "Slice bounds must be integers from 0 to the view's length.";
+  size_t start = checkPosition(args[1], view->length, message);
+  size_t end = checkPosition(args[2], view->length, message);
+
+  if (start > end)
+    throw new NativeError("Slice start must not be after its end.");
+
+  return std::shared_ptr<NativeObject>(std::make_shared<LoxView>(
+      view->mapping, view->offset + start, end - start));
+}
+
+std::string SliceFunc::toString() const { return "<native fn>"; }
+
+// FindFunc
+
+int FindFunc::arity() { return 2; }
+
+LiteralObject FindFunc::call(Interpreter &interpreter,
+                             std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxView> view = checkView(args[0], "find");
+
+  if (!std::holds_alternative<std::shared_ptr<LoxString>>(args[1]))
+    throw new NativeError("Needle for 'find' must be a string.");
+
+  size_t index = view->bytes().find(
+      std::get<std::shared_ptr<LoxString>>(args[1])->str());
+
+  return index == std::string_view::npos ? -1.0 : static_cast<double>(index);
+}
+
+std::string FindFunc::toString() const { return "<native fn>"; }
+
+// ByteAtFunc
+
+int ByteAtFunc::arity() { return 2; }
+
+LiteralObject ByteAtFunc::call(Interpreter &interpreter,
+                               std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxView> view = checkView(args[0], "byteAt");
+
+  if (view->length == 0)
+    throw new NativeError("Index out of bounds.");
+
+  size_t index =
+      checkPosition(args[1], view->length - 1, "Index out of bounds.");
+
+  return static_cast<double>(
+      static_cast<unsigned char>(view->bytes()[index]));
+}
+
+std::string ByteAtFunc::toString() const { return "<native fn>"; }
+
+// TextFunc
+
+int TextFunc::arity() { return 1; }
+
+LiteralObject TextFunc::call(Interpreter &interpreter,
+                             std::vector<LiteralObject> args) {
+  return std::make_shared<LoxString>(
+      std::string(checkView(args[0], "text")->bytes()));
+}
+
+std::string TextFunc::toString() const { return "<native fn>"; }
+
+// AdviseFunc
+
+int AdviseFunc::arity() { return 2; }
+
+LiteralObject AdviseFunc::call(Interpreter &interpreter,
+                               std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxView> view = checkView(args[0], "advise");
+
+#ifdef __unix__
+  static const std::unordered_map<std::string, int> hints{
+      {"normal", MADV_NORMAL},
+      {"sequential", MADV_SEQUENTIAL},
+      {"random", MADV_RANDOM},
+      {"willneed", MADV_WILLNEED},
+      {"dontneed", MADV_DONTNEED}};
+
+  auto hint = hints.end();
+
+  if (auto *name = std::get_if<std::shared_ptr<LoxString>>(&args[1]))
+    hint = hints.find((*name)->str());
+
+  if (hint == hints.end())
+    throw new NativeError("Hint must be 'normal', 'sequential', 'random', "
+                          "'willneed' or 'dontneed'.");
+
+  if (view->length == 0)
+    return std::monostate{};
+
+  // madvise() wants the range to start on a page boundary.
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t start = view->offset / page * page;
+  madvise(const_cast<char *>(view->mapping->data) + start,
+          view->offset + view->length - start, hint->second);
+#endif
+
+  return std::monostate{};
+}
+
+std::string AdviseFunc::toString() const { return "<native fn>"; }
@@ -0,0 +1,287 @@
+#include "lox_reader.hpp"
+#include "lox_string.hpp"
+#include "output.hpp"
+#include "runtime_error.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <variant>
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+extern Output output;
+
+// LoxReader
+
+LoxReader::LoxReader(std::string name, std::FILE *file, bool owned)
+    : name(std::move(name)), file(file), owned(owned), buffer(BUFFER_SIZE) {}
+
+LoxReader::~LoxReader() { close(); }
+
+// Reads more input after end, first moving what is left of the buffer to
+// its front. False at the end of the input.
+bool LoxReader::fill() {
+  if (atEnd)
+    return false;
+
+  if (start > 0) {
+    std::memmove(buffer.data(), buffer.data() + start, end - start);
+    end -= start;
+    start = 0;
+  }
+
+  if (end == buffer.size())
+    buffer.resize(buffer.size() * 2);
+
+  // Whatever the script printed so far may be a prompt for this input.
+  if (file == stdin)
+    output.flush();
+
+#ifdef __unix__
+  // read() returns what is available, where fread() would wait for a full
+  // buffer before handing over a line typed at a terminal.
+  ssize_t count;
+
+  do {
+    count = ::read(fileno(file), buffer.data() + end, buffer.size() - end);
+  } while (count < 0 && errno == EINTR);
+#else
+  std::ptrdiff_t count =
+      std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+
+  if (count == 0 && std::ferror(file))
+    count = -1;
+#endif
+
+  if (count < 0)
+    throw new NativeError("Error reading " + name + ": " +
+                          std::strerror(errno) + ".");
+
+  if (count == 0) {
+    atEnd = true;
+    return false;
+  }
+
+  end += count;
+  return true;
+}
+
+void LoxReader::checkOpen() const {
+  if (file == nullptr)
+    throw new NativeError("Can't read from closed " + toString() + ".");
+}
+
+LiteralObject LoxReader::readLine() {
+  checkOpen();
+  size_t scanned = 0;
+
+  while (true) {
+    const char *first = buffer.data() + start;
+    const char *newline = static_cast<const char *>(
+        std::memchr(first + scanned, '\n', end - start - scanned));
+
+    if (newline != nullptr) {
+      size_t length = newline - first;
+      start += length + 1;
+
+      if (length > 0 && first[length - 1] == '\r')
+        length--;
+
+      return std::make_shared<LoxString>(std::string(first, length));
+    }
+
+    scanned = end - start;
+
+    if (!fill())
+      break;
+  }
+
+  if (start == end)
+    return std::monostate{};
+
+  std::string last(buffer.data() + start, end - start);
+  start = end;
+  return std::make_shared<LoxString>(std::move(last));
+}
+
+LiteralObject LoxReader::readChunk(size_t size) {
+  checkOpen();
+
+  while (end - start < size && fill()) {
+  }
+
+  if (start == end)
+    return std::monostate{};
+
+  size_t length = std::min(size, end - start);
+  std::string chunk(buffer.data() + start, length);
+  start += length;
+
+  return std::make_shared<LoxString>(std::move(chunk));
+}
+
+std::string_view LoxReader::readRecord() {
+  checkOpen();
+  size_t scanned = 0;
+  bool quoted = false;
+
+  while (true) {
+    const char *first = buffer.data() + start;
+    size_t available = end - start;
+
+    while (scanned < available) {
+      const char *rest = first + scanned;
+
+      // Inside quotes only the closing quote matters; a doubled quote just
+      // closes and reopens them.
+      if (quoted) {
+        const char *quote = static_cast<const char *>(
+            std::memchr(rest, '"', available - scanned));
+
+        if (quote == nullptr) {
+          scanned = available;
+        } else {
+          scanned = quote - first + 1;
+          quoted = false;
+        }
+
+        continue;
+      }
+
+      const char *newline = static_cast<const char *>(
+          std::memchr(rest, '\n', available - scanned));
+      size_t stop = newline != nullptr ? newline - first : available;
+      const char *quote = static_cast<const char *>(
+          std::memchr(rest, '"', stop - scanned));
+
+      if (quote != nullptr) {
+        scanned = quote - first + 1;
+        quoted = true;
+      } else if (newline != nullptr) {
+        start += stop + 1;
+        return std::string_view(first, stop);
+      } else {
+        scanned = available;
+      }
+    }
+
+    if (!fill())
+      break;
+  }
+
+  if (start == end)
+    return std::string_view{};
+
+  std::string_view last(buffer.data() + start, end - start);
+  start = end;
+  return last;
+}
+
+void LoxReader::close() {
+  if (file != nullptr && owned)
+    std::fclose(file);
+
+  file = nullptr;
+}
+
+std::string LoxReader::toString() const { return "<reader " + name + ">"; }
+
+std::shared_ptr<LoxReader> checkReader(const LiteralObject &obj,
+                                       std::string fnName) {
+  std::shared_ptr<LoxReader> reader{};
+
+  if (auto *object = std::get_if<std::shared_ptr<NativeObject>>(&obj))
+    reader = std::dynamic_pointer_cast<LoxReader>(*object);
+
+  if (reader == nullptr)
+    throw new NativeError("Argument to '" + fnName + "' must be a reader.");
+
+  return reader;
+}
+
+// OpenFunc
+
+int OpenFunc::arity() { return 1; }
+
+LiteralObject OpenFunc::call(Interpreter &interpreter,
+                             std::vector<LiteralObject> args) {
+  if (!std::holds_alternative<std::shared_ptr<LoxString>>(args[0]))
+    throw new NativeError("Argument to 'open' must be a string.");
+
+  std::string path = std::get<std::shared_ptr<LoxString>>(args[0])->str();
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+
+  // Scripts have no way to catch an error, so a missing file is nil.
+  if (file == nullptr)
+    return std::monostate{};
+
+  return std::shared_ptr<NativeObject>(
+      std::make_shared<LoxReader>(path, file, true));
+}
+
+std::string OpenFunc::toString() const { return "<native fn>"; }
+
+// StdinFunc
+
+int StdinFunc::arity() { return 0; }
+
+LiteralObject StdinFunc::call(Interpreter &interpreter,
+                              std::vector<LiteralObject> args) {
+  if (reader == nullptr)
+    reader = std::make_shared<LoxReader>("stdin", stdin, false);
+
+  return std::shared_ptr<NativeObject>(reader);
+}
+
+std::string StdinFunc::toString() const { return "<native fn>"; }
+
+// ReadLineFunc
+
+int ReadLineFunc::arity() { return 1; }
+
+LiteralObject ReadLineFunc::call(Interpreter &interpreter,
+                                 std::vector<LiteralObject> args) {
+  return checkReader(args[0], "readLine")->readLine();
+}
+
+std::string ReadLineFunc::toString() const { return "<native fn>"; }
+
+// ReadChunkFunc
+
+int ReadChunkFunc::arity() { return 2; }
+
+LiteralObject ReadChunkFunc::call(Interpreter &interpreter,
+                                  std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxReader> reader = checkReader(args[0], "readChunk");
+  const double *size = std::get_if<double>(&args[1]);
+
+  if (size == nullptr || *size < 1 || *size != std::floor(*size))
+    throw new NativeError("Chunk size must be a positive integer.");
+
+  // A size past what a size_t holds asks for the rest of the input, and
+  // would be undefined to cast.
+  if (*size >= static_cast<double>(SIZE_MAX))
+    return reader->readChunk(SIZE_MAX);
+
+  return reader->readChunk(static_cast<size_t>(*size));
+}
+
+std::string ReadChunkFunc::toString() const { return "<native fn>"; }
+
+// CloseFunc
+
+int CloseFunc::arity() { return 1; }
+
+LiteralObject CloseFunc::call(Interpreter &interpreter,
+                              std::vector<LiteralObject> args) {
+  checkReader(args[0], "close")->close();
+  return std::monostate{};
+}
+
+std::string CloseFunc::toString() const { return "<native fn>"; }
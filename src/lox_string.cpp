@@ -0,0 +1,144 @@
+#include "lox_string.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+LoxString::LoxString(std::string chars)
+    : chars(std::move(chars)), length(this->chars.size()) {}
+
+LoxString::LoxString(std::shared_ptr<LoxString> left,
+                     std::shared_ptr<LoxString> right)
+    : left(std::move(left)), right(std::move(right)) {
+  length = this->left->length + this->right->length;
+}
+
+LoxString::~LoxString() {
+  // A string built in a loop is a rope as deep as the loop is long. Free it
+  // with an explicit worklist so the destructors don't recurse that deep.
+  std::vector<std::shared_ptr<LoxString>> pending{};
+
+  if (left)
+    pending.push_back(std::move(left));
+  if (right)
+    pending.push_back(std::move(right));
+
+  while (!pending.empty()) {
+    std::shared_ptr<LoxString> node = std::move(pending.back());
+    pending.pop_back();
+
+    if (node.use_count() == 1) {
+      if (node->left)
+        pending.push_back(std::move(node->left));
+      if (node->right)
+        pending.push_back(std::move(node->right));
+    }
+  }
+}
+
+std::shared_ptr<LoxString>
+LoxString::concat(const std::shared_ptr<LoxString> &left,
+                  const std::shared_ptr<LoxString> &right) {
+  if (left->length == 0)
+    return right;
+  if (right->length == 0)
+    return left;
+
+  if (left->length + right->length < ROPE_THRESHOLD) {
+    std::string chars(left->view());
+    chars += right->view();
+    return std::make_shared<LoxString>(std::move(chars));
+  }
+
+  return std::make_shared<LoxString>(left, right);
+}
+
+std::shared_ptr<LoxString>
+LoxString::substr(const std::shared_ptr<LoxString> &string, size_t offset,
+                  size_t length) {
+  if (offset == 0 && length == string->length)
+    return string;
+
+  if (length < ROPE_THRESHOLD)
+    return std::make_shared<LoxString>(
+        std::string(string->view().substr(offset, length)));
+
+  // Slices always point at a flat string, never at another slice.
+  std::shared_ptr<LoxString> root = string;
+
+  if (string->base) {
+    root = string->base;
+    offset += string->offset;
+  }
+
+  root->str();
+
+  auto slice = std::make_shared<LoxString>(std::string());
+  slice->base = std::move(root);
+  slice->offset = offset;
+  slice->length = length;
+  return slice;
+}
+
+void LoxString::flatten() const {
+  std::string flat{};
+  flat.reserve(length);
+
+  // In-order walk over the leaves, right child pushed first.
+  std::vector<const LoxString *> stack{this};
+
+  while (!stack.empty()) {
+    const LoxString *node = stack.back();
+    stack.pop_back();
+
+    if (node->left) {
+      stack.push_back(node->right.get());
+      stack.push_back(node->left.get());
+    } else {
+      flat += node->view();
+    }
+  }
+
+  chars = std::move(flat);
+
+  // Dropping the children goes through the same iterative teardown.
+  LoxString detached(std::move(left), std::move(right));
+}
+
+size_t LoxString::size() const { return length; }
+
+size_t LoxString::hash() const {
+  if (!hashed) {
+    hashCode = std::hash<std::string_view>{}(view());
+    hashed = true;
+  }
+
+  return hashCode;
+}
+
+const std::string &LoxString::str() const {
+  if (left) {
+    flatten();
+  } else if (base) {
+    chars = std::string(view());
+    base.reset();
+  }
+
+  return chars;
+}
+
+std::string_view LoxString::view() const {
+  if (base)
+    return std::string_view(base->chars).substr(offset, length);
+
+  return str();
+}
+
+bool LoxString::operator==(const LoxString &other) const {
+  if (this == &other)
+    return true;
+  if (length != other.length)
+    return false;
+  if (hashed && other.hashed && hashCode != other.hashCode)
+    return false;
+  return view() == other.view();
+}
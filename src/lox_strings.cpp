@@ -0,0 +1,205 @@
+#include "lox_strings.hpp"
+#include "lox_list.hpp"
+#include "lox_string.hpp"
+#include "runtime_error.hpp"
+#include "string_kernels.hpp"
+#include <cmath>
+#include <memory>
+#include <string_view>
+#include <variant>
+
+static std::shared_ptr<LoxString> checkString(const LiteralObject &obj,
+                                              const std::string &fnName) {
+  if (!std::holds_alternative<std::shared_ptr<LoxString>>(obj))
+    throw new NativeError("Arguments to '" + fnName + "' must be strings.");
+
+  return std::get<std::shared_ptr<LoxString>>(obj);
+}
+
+// Counts above limit come back as limit, compared as doubles: the cast of a
+// double at or past 2^64 to size_t is undefined.
+static size_t checkCount(const LiteralObject &obj, size_t limit,
+                         const std::string &what) {
+  const double *number = std::get_if<double>(&obj);
+
+  if (number == nullptr || *number != std::floor(*number) || *number < 0)
+    throw new NativeError(what + " must be a non-negative integer.");
+
+  if (*number > static_cast<double>(limit))
+    return limit;
+
+  return static_cast<size_t>(*number);
+}
+
+static bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' ||
+         c == '\v';
+}
+
+// SubstrFunc
+
+int SubstrFunc::arity() { return 3; }
+
+LiteralObject SubstrFunc::call(Interpreter &interpreter,
+                               std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxString> string = checkString(args[0], "substr");
+  size_t start = checkCount(args[1], string->size() + 1, "Start");
+  size_t length = checkCount(args[2], string->size(), "Length");
+
+  if (start > string->size())
+    throw new NativeError("Start is past the end of the string.");
+
+  return LoxString::substr(string, start,
+                           std::min(length, string->size() - start));
+}
+
+std::string SubstrFunc::toString() const { return "<native fn>"; }
+
+// IndexOfFunc
+
+int IndexOfFunc::arity() { return 2; }
+
+LiteralObject IndexOfFunc::call(Interpreter &interpreter,
+                                std::vector<LiteralObject> args) {
+  size_t index = findBytes(checkString(args[0], "indexOf")->view(),
+                           checkString(args[1], "indexOf")->view());
+
+  return index == std::string_view::npos ? -1.0 : static_cast<double>(index);
+}
+
+std::string IndexOfFunc::toString() const { return "<native fn>"; }
+
+// SplitFunc
+
+int SplitFunc::arity() { return 2; }
+
+LiteralObject SplitFunc::call(Interpreter &interpreter,
+                              std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxString> string = checkString(args[0], "split");
+  std::string_view separator = checkString(args[1], "split")->view();
+
+  if (separator.empty())
+    throw new NativeError("Separator must not be empty.");
+
+  std::string_view chars = string->view();
+  auto pieces = std::make_shared<LoxList>();
+  size_t start = 0;
+
+  while (true) {
+    size_t match = findBytes(chars, separator, start);
+
+    if (match == std::string_view::npos)
+      break;
+
+    pieces->elements.push_back(
+        LoxString::substr(string, start, match - start));
+    start = match + separator.size();
+  }
+
+  pieces->elements.push_back(
+      LoxString::substr(string, start, chars.size() - start));
+
+  return pieces;
+}
+
+std::string SplitFunc::toString() const { return "<native fn>"; }
+
+// ReplaceFunc
+
+int ReplaceFunc::arity() { return 3; }
+
+LiteralObject ReplaceFunc::call(Interpreter &interpreter,
+                                std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxString> string = checkString(args[0], "replace");
+  std::string_view from = checkString(args[1], "replace")->view();
+  std::string_view to = checkString(args[2], "replace")->view();
+
+  if (from.empty())
+    throw new NativeError("String to replace must not be empty.");
+
+  std::string_view chars = string->view();
+  size_t match = findBytes(chars, from);
+
+  if (match == std::string_view::npos)
+    return string;
+
+  std::string result{};
+  result.reserve(chars.size());
+  size_t start = 0;
+
+  while (match != std::string_view::npos) {
+    result.append(chars.substr(start, match - start));
+    result.append(to);
+    start = match + from.size();
+    match = findBytes(chars, from, start);
+  }
+
+  result.append(chars.substr(start));
+  return std::make_shared<LoxString>(std::move(result));
+}
+
+std::string ReplaceFunc::toString() const { return "<native fn>"; }
+
+// ToUpperFunc
+
+int ToUpperFunc::arity() { return 1; }
+
+LiteralObject ToUpperFunc::call(Interpreter &interpreter,
+                                std::vector<LiteralObject> args) {
+  std::string_view chars = checkString(args[0], "toUpper")->view();
+  std::string result(chars.size(), '\0');
+  toUpperBytes(chars.data(), result.data(), chars.size());
+  return std::make_shared<LoxString>(std::move(result));
+}
+
+std::string ToUpperFunc::toString() const { return "<native fn>"; }
+
+// ToLowerFunc
+
+int ToLowerFunc::arity() { return 1; }
+
+LiteralObject ToLowerFunc::call(Interpreter &interpreter,
+                                std::vector<LiteralObject> args) {
+  std::string_view chars = checkString(args[0], "toLower")->view();
+  std::string result(chars.size(), '\0');
+  toLowerBytes(chars.data(), result.data(), chars.size());
+  return std::make_shared<LoxString>(std::move(result));
+}
+
+std::string ToLowerFunc::toString() const { return "<native fn>"; }
+
+// TrimFunc
+
+int TrimFunc::arity() { return 1; }
+
+LiteralObject TrimFunc::call(Interpreter &interpreter,
+                             std::vector<LiteralObject> args) {
+  std::shared_ptr<LoxString> string = checkString(args[0], "trim");
+  std::string_view chars = string->view();
+  size_t start = 0;
+  size_t end = chars.size();
+
+  while (start < end && isSpace(chars[start]))
+    start++;
+
+  while (end > start && isSpace(chars[end - 1]))
+    end--;
+
+  return LoxString::substr(string, start, end - start);
+}
+
+std::string TrimFunc::toString() const { return "<native fn>"; }
+
+// StartsWithFunc
+
+int StartsWithFunc::arity() { return 2; }
+
+LiteralObject StartsWithFunc::call(Interpreter &interpreter,
+                                   std::vector<LiteralObject> args) {
+  std::string_view chars = checkString(args[0], "startsWith")->view();
+  std::string_view prefix = checkString(args[1], "startsWith")->view();
+
+  return chars.substr(0, prefix.size()) == prefix;
+}
+
+std::string StartsWithFunc::toString() const { return "<native fn>"; }
@@ -1,19 +1,30 @@
+#include "cpp_emitter.hpp"
 #include "error_reporter.hpp"
 #include "expr.hpp"
 #include "interpreter.hpp"
 #include "lox_callable.hpp"
+#include "metrics.hpp"
+#include "module_loader.hpp"
+#include "options.hpp"
+#include "output.hpp"
 #include "parser.hpp"
+#include "pass_manager.hpp"
 #include "resolver.hpp"
 #include "scanner.hpp"
+#include "server.hpp"
 #include "token.hpp"
 #include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
 
 ErrorReporter errorReporter{};
+Options options{};
+Output output{};
 Interpreter interpreter{};
+ModuleLoader modules{interpreter};
 
 std::string readFile(std::string fileName) {
   std::ifstream file(fileName);
@@ -42,7 +53,25 @@ std::string readFile(std::string fileName) {
   return content;
 }
 
-void run(std::string source) {
+void emitCpp(std::vector<std::shared_ptr<Stmt>> &stmts) {
+  CppEmitter emitter{interpreter};
+
+  if (options.outputFile.empty()) {
+    emitter.emit(stmts, std::cout);
+    return;
+  }
+
+  std::ofstream file(options.outputFile);
+  emitter.emit(stmts, file);
+
+  if (!file) {
+    std::cerr << "Error writing file: " << options.outputFile << ".\n";
+    errorReporter.hadError = true;
+  }
+}
+
+void run(std::string source, const std::string &directory,
+         const std::string &script) {
   std::shared_ptr<Scanner> scanner = std::make_shared<Scanner>(source);
 
   std::vector<std::shared_ptr<Token>> tokens = scanner->scanTokens();
@@ -63,21 +92,57 @@ void run(std::string source) {
   if (errorReporter.hadError)
     return;
 
+  std::vector<std::shared_ptr<Stmt>> imported =
+      modules.load(parser->imports, directory, script);
+
+  if (errorReporter.hadError)
+    return;
+
+  stmts.insert(stmts.begin(), imported.begin(), imported.end());
+
+  std::shared_ptr<PassManager> passManager = std::make_shared<PassManager>(
+      interpreter, options.optLevel, options.passToggles);
+  passManager->run(stmts);
+
+  if (options.emitCpp) {
+    emitCpp(stmts);
+    return;
+  }
+
   if (!stmts.empty())
     interpreter.interpret(stmts);
+
+  // The reports describe the output still sitting in the buffer, so it
+  // goes first.
+  if (options.stats || options.quickenStats)
+    output.flush();
+
+  if (options.stats) {
+    passManager->report(std::cerr);
+    modules.report(std::cerr);
+  }
+
+  if (options.quickenStats)
+    Interpreter::reportQuickening(std::cerr);
 }
 
-void runFile(std::string fileName) {
+int runFile(std::string fileName) {
   std::string fileContent = readFile(fileName);
 
-  run(fileContent);
+  std::string directory =
+      std::filesystem::path(fileName).parent_path().string();
+
+  run(fileContent, directory.empty() ? "." : directory, fileName);
 
   if (errorReporter.hadError || errorReporter.hadRuntimeError)
-    std::exit(EXIT_FAILURE);
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
 }
 
 void runPrompt() {
   while (true) {
+    output.flush();
     std::cout << "> ";
 
     std::string line{};
@@ -87,19 +152,153 @@ void runPrompt() {
     if (line == "\0")
       break;
 
-    run(line);
+    run(line, ".", "");
 
     errorReporter.hadError = false;
   }
 }
 
-int main(int argc, char *argv[]) {
-  if (argc > 2) {
-    std::cerr << "Usage: CppLox [file]\n";
+int usage() {
+  std::cerr << "Usage: CppLox [options] [file]\n"
+            << "Options:\n"
+            << "  --quicken-stats  Print per-node specialization counters\n"
+            << "  --stats          Print per-pass timings and statistics\n"
+            << "  -O<level>        Optimization level, 0 to 2 (default 1)\n"
+            << "  -f<pass>         Enable a pass regardless of level\n"
+            << "  -fno-<pass>      Disable a pass regardless of level\n"
+            << "  --inline-threshold=<nodes>\n"
+            << "                   Largest function body to inline (default "
+            << options.inlineThreshold << ")\n"
+            << "  --memo-size=<entries>\n"
+            << "                   Cache size per memoized function (default "
+            << options.memoCacheSize << ")\n"
+            << "  --jit=off|on|verify\n"
+            << "                   Compile hot pure functions to native code;\n"
+            << "                   verify also runs them interpreted and\n"
+            << "                   aborts on a different result\n"
+            << "  --flush=line|size|exit\n"
+            << "                   When print output is written (default line\n"
+            << "                   on a terminal, size otherwise)\n"
+            << "  --output-buffer=<bytes>\n"
+            << "                   Buffer size flushed under --flush=size\n"
+            << "                   (default " << options.outputBuffer << ")\n"
+            << "  --output-thread  Write print output on a background thread\n"
+            << "  --emit-cpp       Translate the script to C++ instead of\n"
+            << "                   running it; build that against\n"
+            << "                   libLoxRuntime\n"
+            << "  -o <file>        Where --emit-cpp writes (default stdout)\n"
+            << "  --metrics=<port|path>\n"
+            << "                   Serve runtime counters over HTTP, in the\n"
+            << "                   Prometheus format, on a localhost port or\n"
+            << "                   a Unix socket\n"
+            << "  --serve <socket> [prelude]\n"
+            << "                   Run scripts sent with --connect, each in\n"
+            << "                   a process forked from this one after it\n"
+            << "                   runs prelude\n"
+            << "  --connect <socket>\n"
+            << "                   Have the --serve process at socket run\n"
+            << "                   the rest of the command line\n"
+            << "Passes:\n";
+
+  for (const std::string &pass : PassManager::passNames()) {
+    std::cerr << "  " << pass << "\n";
+  }
+
+  return EXIT_FAILURE;
+}
+
+// Parses the options and file name of a command line and runs it.
+int runArgs(const std::vector<std::string> &args) {
+  std::string fileName{};
+
+  for (size_t i = 0; i < args.size(); i++) {
+    const std::string &arg = args[i];
+
+    if (arg == "--quicken-stats") {
+      options.quickenStats = true;
+    } else if (arg == "--stats") {
+      options.stats = true;
+    } else if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+      options.optLevel = arg[2] - '0';
+    } else if (arg.rfind("-fno-", 0) == 0 &&
+               PassManager::isPass(arg.substr(5))) {
+      options.passToggles[arg.substr(5)] = false;
+    } else if (arg.rfind("-f", 0) == 0 &&
+               PassManager::isPass(arg.substr(2))) {
+      options.passToggles[arg.substr(2)] = true;
+    } else if (arg.rfind("--inline-threshold=", 0) == 0) {
+      options.inlineThreshold = std::strtoul(arg.c_str() + 19, nullptr, 10);
+    } else if (arg.rfind("--memo-size=", 0) == 0) {
+      options.memoCacheSize = std::strtoul(arg.c_str() + 12, nullptr, 10);
+    } else if (arg == "--jit=off" || arg == "--jit=on" ||
+               arg == "--jit=verify") {
+      options.passToggles["jit"] = arg != "--jit=off";
+      options.jitVerify = arg == "--jit=verify";
+    } else if (arg == "--flush=line") {
+      options.flushPolicy = Output::Policy::LINE;
+    } else if (arg == "--flush=size") {
+      options.flushPolicy = Output::Policy::SIZE;
+    } else if (arg == "--flush=exit") {
+      options.flushPolicy = Output::Policy::EXIT;
+    } else if (arg.rfind("--output-buffer=", 0) == 0) {
+      options.outputBuffer = std::strtoul(arg.c_str() + 16, nullptr, 10);
+    } else if (arg == "--output-thread") {
+      options.outputThread = true;
+    } else if (arg == "--emit-cpp") {
+      options.emitCpp = true;
+    } else if (arg.rfind("--metrics=", 0) == 0 && arg.size() > 10) {
+      options.metricsAddress = arg.substr(10);
+    } else if (arg == "-o" && i + 1 < args.size()) {
+      options.outputFile = args[++i];
+    } else if (!arg.empty() && arg[0] != '-' && fileName.empty()) {
+      fileName = arg;
+    } else {
+      return usage();
+    }
+  }
+
+  if (options.emitCpp && fileName.empty())
+    return usage();
+
+  output.configure(options.flushPolicy, options.outputBuffer,
+                   options.outputThread);
+
+  if (!options.metricsAddress.empty() &&
+      !Metrics::listen(options.metricsAddress))
     return EXIT_FAILURE;
-  } else if (argc == 2) {
-    runFile(argv[1]);
+
+  int status = EXIT_SUCCESS;
+
+  if (!fileName.empty()) {
+    status = runFile(fileName);
   } else {
+    options.interactive = true;
     runPrompt();
   }
+
+  output.flush();
+  Metrics::stop();
+  return status;
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+
+  if (args.size() >= 2 && args[0] == "--serve") {
+    if (args.size() > 3)
+      return usage();
+
+    // Every request starts from the state the prelude leaves behind: its
+    // globals defined and its modules compiled.
+    if (args.size() == 3 && runFile(args[2]) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+
+    output.flush();
+    return serve(args[1], runArgs);
+  }
+
+  if (args.size() >= 2 && args[0] == "--connect")
+    return connectAndRun(args[1], {args.begin() + 2, args.end()});
+
+  return runArgs(args);
 }
@@ -0,0 +1,120 @@
+#include "memo_cache.hpp"
+#include "lox_string.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <variant>
+
+size_t MemoCache::KeyHash::operator()(
+    const std::vector<LiteralObject> &key) const {
+  size_t hash = key.size();
+
+  for (const LiteralObject &arg : key) {
+    size_t part = arg.index();
+
+    if (const double *num = std::get_if<double>(&arg)) {
+      uint64_t bits;
+      std::memcpy(&bits, num, sizeof(bits));
+      part = std::hash<uint64_t>{}(bits);
+    } else if (const auto *str =
+                   std::get_if<std::shared_ptr<LoxString>>(&arg)) {
+      part = (*str)->hash();
+    } else if (const bool *val = std::get_if<bool>(&arg)) {
+      part = *val ? 3 : 2;
+    }
+
+    hash = hash * 31 + part;
+  }
+
+  return hash;
+}
+
+bool MemoCache::KeyEqual::operator()(
+    const std::vector<LiteralObject> &a,
+    const std::vector<LiteralObject> &b) const {
+  if (a.size() != b.size())
+    return false;
+
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].index() != b[i].index())
+      return false;
+
+    if (const double *num = std::get_if<double>(&a[i])) {
+      if (std::memcmp(num, std::get_if<double>(&b[i]), sizeof(double)) != 0)
+        return false;
+    } else if (!isEqual(a[i], b[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+MemoCache::MemoCache(std::string name, size_t capacity)
+    : capacity(capacity), name(std::move(name)) {}
+
+bool MemoCache::isKey(const std::vector<LiteralObject> &args) {
+  for (const LiteralObject &arg : args) {
+    if (!std::holds_alternative<double>(arg) &&
+        !std::holds_alternative<std::shared_ptr<LoxString>>(arg) &&
+        !std::holds_alternative<bool>(arg) &&
+        !std::holds_alternative<std::monostate>(arg))
+      return false;
+  }
+
+  return true;
+}
+
+const LiteralObject *MemoCache::find(const std::vector<LiteralObject> &args) {
+  auto entry = entries.find(args);
+
+  if (entry == entries.end()) {
+    misses++;
+    return nullptr;
+  }
+
+  hits++;
+  return &entry->second;
+}
+
+void MemoCache::insert(std::vector<LiteralObject> args, LiteralObject value) {
+  if (capacity == 0)
+    return;
+
+  if (entries.size() >= capacity) {
+    entries.clear();
+    stringBytes = 0;
+    flushes++;
+  }
+
+  for (const LiteralObject &arg : args) {
+    stringBytes += stringSize(arg);
+  }
+  stringBytes += stringSize(value);
+
+  entries.emplace(std::move(args), std::move(value));
+}
+
+size_t MemoCache::size() const { return entries.size(); }
+
+size_t MemoCache::stringSize(const LiteralObject &value) {
+  if (const auto *str = std::get_if<std::shared_ptr<LoxString>>(&value))
+    return sizeof(LoxString) + (*str)->size();
+
+  return 0;
+}
+
+size_t MemoCache::memoryBytes() const {
+  // Each entry is a hash node holding the key vector and the value, plus
+  // the key's own element buffer.
+  size_t nodeBytes = sizeof(void *) + sizeof(size_t) +
+                     sizeof(std::vector<LiteralObject>) + sizeof(LiteralObject);
+  size_t bytes = entries.bucket_count() * sizeof(void *) +
+                 entries.size() * nodeBytes + stringBytes;
+
+  for (const auto &entry : entries) {
+    bytes += entry.first.capacity() * sizeof(LiteralObject);
+  }
+
+  return bytes;
+}
@@ -0,0 +1,43 @@
+#include "memoization.hpp"
+#include "options.hpp"
+#include "purity_analysis.hpp"
+#include <iomanip>
+#include <memory>
+
+extern Options options;
+
+Memoization::Memoization(Interpreter &interpreter)
+    : interpreter(interpreter) {}
+
+std::string Memoization::name() const { return "memoize"; }
+
+void Memoization::run(std::vector<std::shared_ptr<Stmt>> &statements) {
+  if (options.interactive)
+    return;
+
+  PurityAnalysis purity(interpreter);
+  purity.run(statements);
+  functions = purity.topLevelFunctions;
+
+  for (Func *func : purity.pureFunctions) {
+    func->memo =
+        std::make_shared<MemoCache>(func->name.lexeme, options.memoCacheSize);
+    caches.push_back(func->memo);
+  }
+}
+
+void Memoization::report(std::ostream &out) const {
+  out << "memoize: " << caches.size() << " of " << functions
+      << " top-level functions pure\n";
+
+  for (const std::shared_ptr<MemoCache> &cache : caches) {
+    size_t calls = cache->hits + cache->misses;
+    double hitRate = calls == 0 ? 0 : 100.0 * cache->hits / calls;
+
+    out << "  " << cache->name << ": " << cache->hits << " hits, "
+        << cache->misses << " misses (" << std::fixed << std::setprecision(1)
+        << hitRate << "% hit), " << cache->size() << " entries, ~"
+        << cache->memoryBytes() << " bytes, " << cache->flushes
+        << " flushes\n";
+  }
+}
@@ -0,0 +1,315 @@
+#include "metrics.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#ifdef __unix__
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+std::thread Metrics::server{};
+int Metrics::listener = -1;
+std::string Metrics::socketPath{};
+
+struct Description {
+  const char *name;
+  const char *type;
+  const char *help;
+};
+
+static const Description descriptions[Metrics::COUNTERS] = {
+    {"lox_calls_total", "counter",
+     "Calls evaluated, of functions, classes and natives."},
+    {"lox_environments_total", "counter", "Environments allocated."},
+    {"lox_instances_total", "counter", "Class instances created."},
+    {"lox_instances", "gauge", "Class instances alive."},
+    {"lox_field_writes_total", "counter", "Assignments to instance fields."},
+    {"lox_statements_total", "counter", "Statements executed."},
+    {"lox_runtime_errors_total", "counter", "Runtime errors reported."},
+};
+
+Metrics::Registry &Metrics::registry() {
+  static Registry *registry = new Registry{};
+  return *registry;
+}
+
+Metrics::Block *Metrics::attach() {
+  Block *block = new Block{};
+  Registry &threads = registry();
+
+  {
+    std::lock_guard<std::mutex> lock(threads.mutex);
+    threads.blocks.push_back(block);
+  }
+
+  static thread_local Detach detach{};
+  local = block;
+  return block;
+}
+
+Metrics::Detach::~Detach() {
+  Registry &threads = registry();
+  std::lock_guard<std::mutex> lock(threads.mutex);
+
+  for (size_t i = 0; i < threads.blocks.size(); i++) {
+    if (threads.blocks[i] != local)
+      continue;
+
+    for (int counter = 0; counter < COUNTERS; counter++) {
+      threads.retired[counter] +=
+          local->values[counter].load(std::memory_order_relaxed);
+    }
+
+    threads.blocks.erase(threads.blocks.begin() + i);
+    break;
+  }
+
+  delete local;
+  local = nullptr;
+}
+
+// The bytes malloc has handed out and not had back, from its arenas and
+// from chunks it mapped separately; -1 where malloc can't tell.
+static int64_t heapBytes() {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return -1;
+#endif
+}
+
+std::string Metrics::render() {
+  int64_t totals[COUNTERS];
+
+  Registry &threads = registry();
+
+  {
+    std::lock_guard<std::mutex> lock(threads.mutex);
+
+    for (int counter = 0; counter < COUNTERS; counter++) {
+      totals[counter] = threads.retired[counter];
+
+      for (Block *block : threads.blocks) {
+        totals[counter] +=
+            block->values[counter].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::ostringstream out{};
+
+  for (int counter = 0; counter < COUNTERS; counter++) {
+    const Description &metric = descriptions[counter];
+    out << "# HELP " << metric.name << " " << metric.help << "\n"
+        << "# TYPE " << metric.name << " " << metric.type << "\n"
+        << metric.name << " " << totals[counter] << "\n";
+  }
+
+  int64_t heap = heapBytes();
+
+  if (heap >= 0) {
+    out << "# HELP lox_heap_bytes Bytes allocated from the heap and not "
+           "freed.\n"
+        << "# TYPE lox_heap_bytes gauge\n"
+        << "lox_heap_bytes " << heap << "\n";
+  }
+
+  return out.str();
+}
+
+#ifdef __unix__
+
+static bool isPort(const std::string &address) {
+  if (address.empty() || address.size() > 5)
+    return false;
+
+  for (char c : address) {
+    if (c < '0' || c > '9')
+      return false;
+  }
+
+  return std::stoi(address) <= 65535;
+}
+
+static int bindPort(const std::string &port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+  if (fd < 0)
+    return -1;
+
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(std::stoi(port));
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+static int bindPath(const std::string &path) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+
+  if (path.size() >= sizeof(addr.sun_path)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+  // A socket left by an earlier run is replaced; anything else at the path
+  // is somebody's file.
+  struct stat status;
+
+  if (lstat(path.c_str(), &status) == 0) {
+    if (!S_ISSOCK(status.st_mode)) {
+      errno = EEXIST;
+      return -1;
+    }
+
+    ::unlink(path.c_str());
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (fd < 0)
+    return -1;
+
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+bool Metrics::listen(const std::string &address) {
+  stop();
+
+  bool port = isPort(address);
+  int fd = port ? bindPort(address) : bindPath(address);
+
+  if (fd < 0 || ::listen(fd, SOMAXCONN) != 0) {
+    std::cerr << "Can't serve metrics on " << address << ": "
+              << std::strerror(errno) << ".\n";
+
+    if (fd >= 0)
+      ::close(fd);
+
+    return false;
+  }
+
+  listener = fd;
+  socketPath = port ? "" : address;
+  server = std::thread(run);
+  return true;
+}
+
+void Metrics::stop() {
+  if (!server.joinable())
+    return;
+
+  // Wakes the accept() the endpoint thread is blocked in.
+  shutdown(listener, SHUT_RDWR);
+  server.join();
+  ::close(listener);
+  listener = -1;
+
+  // Unless something else has taken the path since.
+  struct stat status;
+
+  if (!socketPath.empty() && lstat(socketPath.c_str(), &status) == 0 &&
+      S_ISSOCK(status.st_mode))
+    ::unlink(socketPath.c_str());
+
+  socketPath.clear();
+}
+
+// Answers every request with the metrics: reads up to the end of the
+// request's headers, whatever they ask for, and closes the connection.
+void Metrics::run() {
+  while (true) {
+    int connection = accept(listener, nullptr, nullptr);
+
+    if (connection < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+
+      return;
+    }
+
+    // A client that never finishes its request can't hold up the next.
+    timeval timeout{1, 0};
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+               sizeof(timeout));
+
+    std::string request{};
+    char chunk[1024];
+
+    while (request.find("\r\n\r\n") == std::string::npos &&
+           request.size() < 8192) {
+      ssize_t count = recv(connection, chunk, sizeof(chunk), 0);
+
+      if (count <= 0)
+        break;
+
+      request.append(chunk, count);
+    }
+
+    std::string body = render();
+    std::string response =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: " +
+        std::to_string(body.size()) +
+        "\r\n"
+        "Connection: close\r\n\r\n" +
+        body;
+
+    const char *data = response.data();
+    size_t size = response.size();
+
+    while (size > 0) {
+      ssize_t count = send(connection, data, size, MSG_NOSIGNAL);
+
+      if (count <= 0)
+        break;
+
+      data += count;
+      size -= count;
+    }
+
+    ::close(connection);
+  }
+}
+
+#else
+
+bool Metrics::listen(const std::string &address) {
+  std::cerr << "--metrics needs sockets.\n";
+  return false;
+}
+
+void Metrics::stop() {}
+
+void Metrics::run() {}
+
+#endif
@@ -0,0 +1,188 @@
+#include "module_loader.hpp"
+#include "error_reporter.hpp"
+#include "lox_string.hpp"
+#include "parser.hpp"
+#include "resolver.hpp"
+#include "scanner.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+extern ErrorReporter errorReporter;
+
+ModuleLoader::ModuleLoader(Interpreter &interpreter)
+    : interpreter(interpreter) {}
+
+std::string ModuleLoader::locate(const std::string &directory,
+                                 const Token &path) {
+  std::filesystem::path file = std::filesystem::path(directory) /
+                               std::get<std::shared_ptr<LoxString>>(
+                                   path.literal)
+                                   ->str();
+
+  return canonical(file.string());
+}
+
+std::string ModuleLoader::canonical(const std::string &path) {
+  std::error_code error{};
+  std::filesystem::path canonical =
+      std::filesystem::weakly_canonical(path, error);
+
+  return error ? path : canonical.string();
+}
+
+std::string ModuleLoader::directoryOf(const std::string &path) {
+  std::string directory = std::filesystem::path(path).parent_path().string();
+  return directory.empty() ? "." : directory;
+}
+
+void ModuleLoader::request(const std::string &path, const Token &import) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!requested.insert(path).second)
+      return;
+  }
+
+  pool->submit([this, path, import] { compile(path, import); });
+}
+
+void ModuleLoader::compile(const std::string &path, const Token &import) {
+  std::ifstream file(path, std::ios::binary);
+
+  if (!file.is_open()) {
+    errorReporter.error(import, "Can't open module '" + path + "'.");
+    return;
+  }
+
+  std::ostringstream contents{};
+  contents << file.rdbuf();
+  std::string source = contents.str();
+
+  std::shared_ptr<Module> module{};
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto cached = cache.find(source);
+
+    if (cached != cache.end()) {
+      module = cached->second;
+      cacheHits++;
+    }
+  }
+
+  if (module == nullptr) {
+    module = std::make_shared<Module>();
+    size_t errors = ErrorReporter::threadErrors();
+
+    Scanner scanner(source);
+    std::vector<std::shared_ptr<Token>> tokens = scanner.scanTokens();
+
+    if (ErrorReporter::threadErrors() == errors) {
+      Parser parser(tokens);
+      module->statements = parser.parse();
+      module->imports = std::move(parser.imports);
+    }
+
+    if (ErrorReporter::threadErrors() == errors)
+      Resolver(interpreter).resolve(module->statements);
+
+    // A module with errors isn't cached, so importing it again reports
+    // them again.
+    if (ErrorReporter::threadErrors() != errors)
+      return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    module = cache.emplace(source, module).first->second;
+    compilations++;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    loaded[path] = module;
+  }
+
+  std::string directory = directoryOf(path);
+
+  for (const Token &nested : module->imports) {
+    request(locate(directory, nested), nested);
+  }
+}
+
+void ModuleLoader::link(const std::string &path,
+                        std::unordered_set<Module *> &visited,
+                        std::vector<std::shared_ptr<Stmt>> &program) {
+  auto entry = loaded.find(path);
+
+  if (entry == loaded.end())
+    return;
+
+  Module *module = entry->second.get();
+
+  if (!visited.insert(module).second)
+    return;
+
+  std::string directory = directoryOf(path);
+
+  for (const Token &import : module->imports) {
+    link(locate(directory, import), visited, program);
+  }
+
+  if (!module->ran) {
+    module->ran = true;
+    program.insert(program.end(), module->statements.begin(),
+                   module->statements.end());
+  }
+}
+
+std::vector<std::shared_ptr<Stmt>>
+ModuleLoader::load(const std::vector<Token> &imports,
+                   const std::string &directory, const std::string &script) {
+  std::vector<std::shared_ptr<Stmt>> program{};
+
+  if (imports.empty())
+    return program;
+
+  // The pool lives for one load, so no threads are left running between
+  // scripts: a child forked by --serve would inherit the pool without its
+  // threads.
+  pool = std::make_unique<ThreadPool>();
+
+  // Marked requested, the script is never compiled as a module, and
+  // linking finds nothing to run under its path.
+  if (!script.empty())
+    requested.insert(canonical(script));
+
+  std::vector<std::string> paths{};
+
+  for (const Token &import : imports) {
+    paths.push_back(locate(directory, import));
+    request(paths.back(), import);
+  }
+
+  pool->wait();
+  pool.reset();
+
+  if (!errorReporter.hadError) {
+    std::unordered_set<Module *> visited{};
+
+    for (const std::string &path : paths) {
+      link(path, visited, program);
+    }
+  }
+
+  loaded.clear();
+  requested.clear();
+
+  return program;
+}
+
+void ModuleLoader::report(std::ostream &out) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (compilations == 0 && cacheHits == 0)
+    return;
+
+  out << "modules: " << compilations << " compiled, " << cacheHits
+      << " cache hits\n";
+}
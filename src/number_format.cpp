@@ -0,0 +1,76 @@
+#include "number_format.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// Lays out the shortest digits of value as JavaScript's Number::toString
+// does. std::to_chars in scientific form without a precision gives those
+// digits (Ryu in libstdc++), and unlike printf ignores the locale; fixed
+// form would write every digit of a large integer's exact value instead.
+char *formatNumber(double value, char *buffer) {
+  if (std::isnan(value)) {
+    std::memcpy(buffer, "nan", 3);
+    return buffer + 3;
+  }
+
+  if (value == 0 || std::isinf(value))
+    return std::to_chars(buffer, buffer + NUMBER_BUFFER_SIZE, value).ptr;
+
+  char scientific[NUMBER_BUFFER_SIZE];
+  char *end = std::to_chars(scientific, scientific + sizeof(scientific),
+                            std::fabs(value), std::chars_format::scientific)
+                  .ptr;
+
+  // "d.ddde±xx" to the digits and n, the position of the decimal point
+  // relative to their start.
+  char digits[20];
+  int count = 0;
+  const char *c = scientific;
+
+  for (; *c != 'e'; c++) {
+    if (*c != '.')
+      digits[count++] = *c;
+  }
+
+  int exponent = 0;
+  std::from_chars(c + (c[1] == '+' ? 2 : 1), end, exponent);
+  int n = exponent + 1;
+
+  char *out = buffer;
+
+  if (value < 0)
+    *out++ = '-';
+
+  if (count <= n && n <= 21) {
+    std::memcpy(out, digits, count);
+    std::memset(out + count, '0', n - count);
+    return out + n;
+  }
+
+  if (0 < n && n <= 21) {
+    std::memcpy(out, digits, n);
+    out[n] = '.';
+    std::memcpy(out + n + 1, digits + n, count - n);
+    return out + count + 1;
+  }
+
+  if (-6 < n && n <= 0) {
+    std::memcpy(out, "0.", 2);
+    std::memset(out + 2, '0', -n);
+    std::memcpy(out + 2 - n, digits, count);
+    return out + 2 - n + count;
+  }
+
+  *out++ = digits[0];
+
+  if (count > 1) {
+    *out++ = '.';
+    std::memcpy(out, digits + 1, count - 1);
+    out += count - 1;
+  }
+
+  *out++ = 'e';
+  *out++ = n - 1 < 0 ? '-' : '+';
+  return std::to_chars(out, buffer + NUMBER_BUFFER_SIZE, std::abs(n - 1)).ptr;
+}
@@ -0,0 +1,121 @@
+#include "output.hpp"
+#include <cstdio>
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+static Output::Policy defaultPolicy() {
+#ifdef __unix__
+  if (isatty(STDOUT_FILENO))
+    return Output::Policy::LINE;
+#endif
+
+  return Output::Policy::SIZE;
+}
+
+Output::Output() : policy(defaultPolicy()) {}
+
+Output::~Output() {
+  flush();
+  stopWriter();
+}
+
+void Output::configure(Policy policy, size_t threshold, bool writerThread) {
+  flush();
+  stopWriter();
+
+  this->policy = policy == Policy::AUTO ? defaultPolicy() : policy;
+  this->threshold = threshold;
+
+  if (writerThread) {
+    stopping = false;
+    writer = std::thread(&Output::run, this);
+  }
+}
+
+void Output::print(const std::string &text) {
+  buffer += text;
+  buffer += '\n';
+
+  if (policy == Policy::LINE ||
+      (policy == Policy::SIZE && buffer.size() >= threshold))
+    submit();
+}
+
+void Output::flush() {
+  submit();
+
+  if (writer.joinable()) {
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this] { return pending.empty() && !writing; });
+  }
+}
+
+void Output::submit() {
+  if (buffer.empty())
+    return;
+
+  if (!writer.joinable()) {
+    write(buffer);
+    buffer.clear();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (pending.empty())
+      pending.swap(buffer);
+    else
+      pending += buffer;
+  }
+
+  buffer.clear();
+  ready.notify_one();
+}
+
+void Output::run() {
+  std::string chunk{};
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (true) {
+    ready.wait(lock, [this] { return stopping || !pending.empty(); });
+
+    if (pending.empty())
+      return;
+
+    chunk.swap(pending);
+    writing = true;
+    lock.unlock();
+
+    write(chunk);
+    chunk.clear();
+
+    lock.lock();
+    writing = false;
+
+    if (pending.empty())
+      drained.notify_all();
+  }
+}
+
+void Output::stopWriter() {
+  if (!writer.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  ready.notify_one();
+  writer.join();
+}
+
+// Goes through stdio, which std::cout is synchronized with, so text written
+// through either comes out in the order it was flushed.
+void Output::write(const std::string &chars) {
+  std::fwrite(chars.data(), 1, chars.size(), stdout);
+  std::fflush(stdout);
+}
@@ -5,6 +5,7 @@
 #include "token.hpp"
 #include "token_type.hpp"
 #include <algorithm>
+#include <cstdlib>
 #include <exception>
 #include <iostream>
 #include <memory>
@@ -62,6 +63,11 @@ std::unique_ptr<Expr> Parser::assignment() {
       Get get = std::get<Get>(*expr);
       Set setExpr(get.object, get.name, std::move(value));
       return std::make_unique<Expr>(setExpr);
+    } else if (std::holds_alternative<Index>(*expr)) {
+      Index index = std::get<Index>(*expr);
+      SetIndex setIndex(index.object, index.bracket, index.index,
+                        std::move(value));
+      return std::make_unique<Expr>(setIndex);
     }
 
     error(*equals, "Invalid assignment target.");
@@ -96,6 +102,43 @@ std::unique_ptr<Expr> Parser::logical_and() {
   return left;
 }
 
+std::unique_ptr<Expr> Parser::makeBinary(std::unique_ptr<Expr> left, Token op,
+                                         std::unique_ptr<Expr> right) {
+  switch (op.type) {
+  case TokenType::PLUS:
+    return std::make_unique<Expr>(Add(std::move(left), op, std::move(right)));
+  case TokenType::MINUS:
+    return std::make_unique<Expr>(
+        Subtract(std::move(left), op, std::move(right)));
+  case TokenType::STAR:
+    return std::make_unique<Expr>(
+        Multiply(std::move(left), op, std::move(right)));
+  case TokenType::SLASH:
+    return std::make_unique<Expr>(
+        Divide(std::move(left), op, std::move(right)));
+  case TokenType::GREATER:
+    return std::make_unique<Expr>(
+        Greater(std::move(left), op, std::move(right)));
+  case TokenType::GREATER_EQUAL:
+    return std::make_unique<Expr>(
+        GreaterEqual(std::move(left), op, std::move(right)));
+  case TokenType::LESS:
+    return std::make_unique<Expr>(Less(std::move(left), op, std::move(right)));
+  case TokenType::LESS_EQUAL:
+    return std::make_unique<Expr>(
+        LessEqual(std::move(left), op, std::move(right)));
+  case TokenType::EQUAL_EQUAL:
+    return std::make_unique<Expr>(Equal(std::move(left), op, std::move(right)));
+  case TokenType::BANG_EQUAL:
+    return std::make_unique<Expr>(
+        NotEqual(std::move(left), op, std::move(right)));
+  default:
+    // Only reached if a binary operator is parsed without a node type.
+    std::cerr << "No binary node for '" << op.lexeme << "'.\n";
+    std::abort();
+  }
+}
+
 std::unique_ptr<Expr> Parser::equality() {
   std::unique_ptr<Expr> expr = comparison();
 
@@ -103,8 +146,7 @@ std::unique_ptr<Expr> Parser::equality() {
     std::shared_ptr<Token> op = previous();
     std::unique_ptr<Expr> right = comparison();
 
-    Binary binary(std::move(expr), *op, std::move(right));
-    expr = std::make_unique<Expr>(std::move(binary));
+    expr = makeBinary(std::move(expr), *op, std::move(right));
   }
 
   return expr;
@@ -118,8 +160,7 @@ std::unique_ptr<Expr> Parser::comparison() {
     std::shared_ptr<Token> op = previous();
     std::unique_ptr<Expr> right = term();
 
-    Binary binary(std::move(expr), *op, std::move(right));
-    expr = std::make_unique<Expr>(std::move(binary));
+    expr = makeBinary(std::move(expr), *op, std::move(right));
   }
 
   return expr;
@@ -132,8 +173,7 @@ std::unique_ptr<Expr> Parser::term() {
     std::shared_ptr<Token> op = previous();
     std::unique_ptr<Expr> right = factor();
 
-    Binary binary(std::move(expr), *op, std::move(right));
-    expr = std::make_unique<Expr>(std::move(binary));
+    expr = makeBinary(std::move(expr), *op, std::move(right));
   }
 
   return expr;
@@ -146,8 +186,7 @@ std::unique_ptr<Expr> Parser::factor() {
     std::shared_ptr<Token> op = previous();
     std::unique_ptr<Expr> right = unary();
 
-    Binary binary(std::move(expr), *op, std::move(right));
-    expr = std::make_unique<Expr>(std::move(binary));
+    expr = makeBinary(std::move(expr), *op, std::move(right));
   }
 
   return expr;
@@ -176,6 +215,12 @@ std::unique_ptr<Expr> Parser::call() {
           consume(TokenType::IDENTIFIER, "Expected property name after '.'");
       Get get(std::move(expr), *name);
       expr = std::make_unique<Expr>(get);
+    } else if (match({TokenType::LEFT_BRACKET})) {
+      std::shared_ptr<Token> bracket = previous();
+      std::unique_ptr<Expr> index = expression();
+      consume(TokenType::RIGHT_BRACKET, "Expected ']' after index.");
+      Index indexExpr(std::move(expr), *bracket, std::move(index));
+      expr = std::make_unique<Expr>(indexExpr);
     } else {
       break;
     }
@@ -232,6 +277,22 @@ std::unique_ptr<Expr> Parser::primary() {
     return std::make_unique<Expr>(std::move(grouping));
   }
 
+  if (match({TokenType::LEFT_BRACKET})) {
+    std::shared_ptr<Token> bracket = previous();
+    std::vector<std::shared_ptr<Expr>> elements{};
+
+    if (!check(TokenType::RIGHT_BRACKET)) {
+      do {
+        elements.push_back(expression());
+      } while (match({TokenType::COMMA}));
+    }
+
+    consume(TokenType::RIGHT_BRACKET, "Expected ']' after list elements.");
+
+    ListLiteral list(*bracket, elements);
+    return std::make_unique<Expr>(std::move(list));
+  }
+
   if (match({TokenType::IDENTIFIER})) {
     std::shared_ptr<Token> name = previous();
     Variable variable(*name);
@@ -268,6 +329,7 @@ void Parser::synchronize() {
     case TokenType::WHILE:
     case TokenType::PRINT:
     case TokenType::RETURN:
+    case TokenType::IMPORT:
       return;
     }
 
@@ -419,6 +481,9 @@ std::unique_ptr<Stmt> Parser::statement() {
   if (match({TokenType::FOR}))
     return forStatement();
 
+  if (match({TokenType::IMPORT}))
+    throw error(*previous(), "Can only import at top level.");
+
   return expressionStatement();
 }
 
@@ -508,10 +573,27 @@ std::unique_ptr<Stmt> Parser::declaration() {
   }
 }
 
+void Parser::importDeclaration() {
+  try {
+    std::shared_ptr<Token> path =
+        consume(TokenType::STRING, "Expected module path after 'import'.");
+    consume(TokenType::SEMICOLON, "Expected ';' after module path.");
+
+    imports.push_back(*path);
+  } catch (const ParseError &error) {
+    synchronize();
+  }
+}
+
 std::vector<std::shared_ptr<Stmt>> Parser::parse() {
   std::vector<std::shared_ptr<Stmt>> statements{};
 
   while (!isAtEnd()) {
+    if (match({TokenType::IMPORT})) {
+      importDeclaration();
+      continue;
+    }
+
     std::unique_ptr<Stmt> stmt = declaration();
 
     if (stmt)
@@ -0,0 +1,143 @@
+#include "pass_manager.hpp"
+#include "ast_verifier.hpp"
+#include "constant_folding.hpp"
+#include "inliner.hpp"
+#include "jit_compilation.hpp"
+#include "loop_invariant_motion.hpp"
+#include "memoization.hpp"
+#include "options.hpp"
+#include "type_inference.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+extern Options options;
+
+#ifdef NDEBUG
+static constexpr bool VERIFY = false;
+#else
+static constexpr bool VERIFY = true;
+#endif
+
+// Passes run in registration order. Inlining goes first so the later passes
+// see through the calls it removes, folding before type inference so that
+// sees the literals it produces, and licm relies on the types inferred.
+const std::vector<PassManager::Registration> PassManager::registry{
+    {"inline", 2,
+     [](Interpreter &interpreter) {
+       return std::make_shared<Inliner>(interpreter);
+     }},
+    {"constant-folding", 1,
+     [](Interpreter &) { return std::make_shared<ConstantFolding>(); }},
+    {"type-inference", 1,
+     [](Interpreter &interpreter) {
+       return std::make_shared<TypeInference>(interpreter);
+     }},
+    {"licm", 2,
+     [](Interpreter &interpreter) {
+       return std::make_shared<LoopInvariantMotion>(interpreter);
+     }},
+    {"memoize", OPT_IN,
+     [](Interpreter &interpreter) {
+       return std::make_shared<Memoization>(interpreter);
+     }},
+    {"jit", OPT_IN,
+     [](Interpreter &interpreter) {
+       return std::make_shared<JitCompilation>(interpreter);
+     }},
+};
+
+PassManager::PassManager(Interpreter &interpreter, int level,
+                         const std::unordered_map<std::string, bool> &toggles) {
+  for (const Registration &registration : registry) {
+    bool enabled = level >= registration.level;
+
+    auto toggle = toggles.find(registration.name);
+    if (toggle != toggles.end())
+      enabled = toggle->second;
+
+    if (enabled)
+      passes.push_back(registration.create(interpreter));
+  }
+}
+
+bool PassManager::isPass(const std::string &name) {
+  for (const Registration &registration : registry) {
+    if (registration.name == name)
+      return true;
+  }
+
+  return false;
+}
+
+std::vector<std::string> PassManager::passNames() {
+  std::vector<std::string> names{};
+
+  for (const Registration &registration : registry) {
+    if (registration.level == OPT_IN) {
+      names.push_back(registration.name + " (opt-in)");
+    } else {
+      names.push_back(registration.name + " (-O" +
+                      std::to_string(registration.level) + ")");
+    }
+  }
+
+  return names;
+}
+
+size_t PassManager::countNodes(std::vector<std::shared_ptr<Stmt>> &statements,
+                               const std::string &after) {
+  AstVerifier verifier{};
+  verifier.verify(statements);
+
+  if (VERIFY && !verifier.errors.empty()) {
+    std::cerr << "Malformed program after " << after << ":\n";
+
+    for (const std::string &error : verifier.errors) {
+      std::cerr << "  " << error << "\n";
+    }
+
+    std::abort();
+  }
+
+  return verifier.nodes;
+}
+
+void PassManager::run(std::vector<std::shared_ptr<Stmt>> &statements) {
+  // Walking the whole program after every pass is only worth it for the
+  // node counts --stats reports or to verify a debug build.
+  bool walk = options.stats || VERIFY;
+  size_t nodes = walk ? countNodes(statements, "resolution") : 0;
+
+  for (std::shared_ptr<Pass> &pass : passes) {
+    auto start = std::chrono::steady_clock::now();
+    pass->run(statements);
+    auto end = std::chrono::steady_clock::now();
+
+    size_t nodesAfter = walk ? countNodes(statements, pass->name()) : 0;
+
+    records.push_back(
+        Record{pass->name(),
+               std::chrono::duration<double, std::milli>(end - start).count(),
+               nodes, nodesAfter});
+    nodes = nodesAfter;
+  }
+}
+
+void PassManager::report(std::ostream &out) const {
+  out << std::left << std::setw(20) << "pass" << std::right << std::setw(10)
+      << "ms" << std::setw(10) << "nodes" << std::setw(10) << "after"
+      << "\n";
+
+  for (const Record &record : records) {
+    out << std::left << std::setw(20) << record.name << std::right
+        << std::setw(10) << std::fixed << std::setprecision(3)
+        << record.millis << std::setw(10) << record.nodesBefore
+        << std::setw(10) << record.nodesAfter << "\n";
+  }
+
+  for (const std::shared_ptr<Pass> &pass : passes) {
+    pass->report(out);
+  }
+}
@@ -0,0 +1,230 @@
+#include "purity_analysis.hpp"
+#include <memory>
+#include <variant>
+
+PurityAnalysis::PurityAnalysis(Interpreter &interpreter)
+    : interpreter(interpreter) {}
+
+void PurityAnalysis::run(std::vector<std::shared_ptr<Stmt>> &statements) {
+  // Only functions declared directly at the top level are candidates; their
+  // locals are exactly the resolved variables in their bodies.
+  for (std::shared_ptr<Stmt> &stmt : statements) {
+    if (Func *func = std::get_if<Func>(stmt.get())) {
+      globalDecls[func->name.lexeme]++;
+      functions.push_back(Function{func, true, {}});
+    } else if (Var *var = std::get_if<Var>(stmt.get())) {
+      globalDecls[var->name.lexeme]++;
+
+      if (var->initializer != nullptr &&
+          std::holds_alternative<Literal>(*var->initializer))
+        constants.insert(var->name.lexeme);
+    } else if (Class *klass = std::get_if<Class>(stmt.get())) {
+      globalDecls[klass->name.lexeme]++;
+    }
+  }
+
+  size_t next = 0;
+
+  for (std::shared_ptr<Stmt> &stmt : statements) {
+    if (std::holds_alternative<Func>(*stmt))
+      current = &functions[next++];
+
+    analyze(stmt);
+    current = nullptr;
+  }
+
+  std::unordered_set<std::string> pure{};
+
+  for (Function &function : functions) {
+    const std::string &name = function.func->name.lexeme;
+
+    if (function.pure && globalDecls[name] == 1 && !globalAssigns.count(name))
+      pure.insert(name);
+  }
+
+  bool changed = true;
+
+  while (changed) {
+    changed = false;
+
+    for (Function &function : functions) {
+      const std::string &name = function.func->name.lexeme;
+
+      if (!pure.count(name))
+        continue;
+
+      for (const std::string &read : function.reads) {
+        if (!isPureRead(read, pure)) {
+          pure.erase(name);
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+
+  topLevelFunctions = functions.size();
+
+  for (Function &function : functions) {
+    if (pure.count(function.func->name.lexeme))
+      pureFunctions.push_back(function.func);
+  }
+}
+
+bool PurityAnalysis::isGlobal(const std::optional<size_t> &id) const {
+  return id.has_value() && !interpreter.locals.count(id.value());
+}
+
+void PurityAnalysis::impure() {
+  if (current != nullptr)
+    current->pure = false;
+}
+
+bool PurityAnalysis::isPureRead(
+    const std::string &name,
+    const std::unordered_set<std::string> &pure) const {
+  if (globalAssigns.count(name))
+    return false;
+
+  auto decls = globalDecls.find(name);
+
+  // Not declared by the program, so it can only be a native.
+  if (decls == globalDecls.end())
+    return name == "len";
+
+  return decls->second == 1 && (pure.count(name) || constants.count(name));
+}
+
+// Statements
+
+void PurityAnalysis::operator()(Block &stmt) { analyze(stmt.statements); }
+
+void PurityAnalysis::operator()(Class &stmt) { impure(); }
+
+void PurityAnalysis::operator()(Expression &stmt) { analyze(stmt.expr); }
+
+void PurityAnalysis::operator()(Func &stmt) {
+  // Closures could capture and outlive anything, so only the top-level
+  // function itself is analysed; nested ones make it impure.
+  if (current != nullptr && current->func != &stmt)
+    impure();
+
+  analyze(stmt.body);
+}
+
+void PurityAnalysis::operator()(If &stmt) {
+  analyze(stmt.condition);
+  analyze(stmt.thenBranch);
+
+  if (stmt.elseBranch != nullptr)
+    analyze(stmt.elseBranch);
+}
+
+void PurityAnalysis::operator()(Print &stmt) {
+  impure();
+  analyze(stmt.expr);
+}
+
+void PurityAnalysis::operator()(Return &stmt) {
+  if (stmt.value != nullptr)
+    analyze(stmt.value);
+}
+
+void PurityAnalysis::operator()(Var &stmt) {
+  if (stmt.initializer != nullptr)
+    analyze(stmt.initializer);
+}
+
+void PurityAnalysis::operator()(While &stmt) {
+  analyze(stmt.condition);
+  analyze(stmt.body);
+}
+
+// Expressions
+
+void PurityAnalysis::operator()(Assign &expr) {
+  if (isGlobal(expr.id)) {
+    globalAssigns.insert(expr.name.lexeme);
+    impure();
+  }
+
+  analyze(expr.value);
+}
+
+void PurityAnalysis::operator()(Logical &expr) {
+  analyze(expr.left);
+  analyze(expr.right);
+}
+
+void PurityAnalysis::operator()(Binary &expr) {
+  analyze(expr.left);
+  analyze(expr.right);
+}
+
+void PurityAnalysis::operator()(Call &expr) {
+  if (!std::holds_alternative<Variable>(*expr.callee))
+    impure();
+
+  analyze(expr.callee);
+
+  for (std::shared_ptr<Expr> &arg : expr.args) {
+    analyze(arg);
+  }
+}
+
+void PurityAnalysis::operator()(Get &expr) {
+  impure();
+  analyze(expr.object);
+}
+
+void PurityAnalysis::operator()(Set &expr) {
+  impure();
+  analyze(expr.object);
+  analyze(expr.value);
+}
+
+void PurityAnalysis::operator()(Grouping &expr) { analyze(expr.expression); }
+
+void PurityAnalysis::operator()(Literal &expr) {}
+
+void PurityAnalysis::operator()(Unary &expr) { analyze(expr.right); }
+
+void PurityAnalysis::operator()(Variable &expr) {
+  if (current != nullptr && isGlobal(expr.id))
+    current->reads.insert(expr.name.lexeme);
+}
+
+void PurityAnalysis::operator()(ListLiteral &expr) {
+  impure();
+
+  for (std::shared_ptr<Expr> &element : expr.elements) {
+    analyze(element);
+  }
+}
+
+void PurityAnalysis::operator()(Index &expr) {
+  impure();
+  analyze(expr.object);
+  analyze(expr.index);
+}
+
+void PurityAnalysis::operator()(SetIndex &expr) {
+  impure();
+  analyze(expr.object);
+  analyze(expr.index);
+  analyze(expr.value);
+}
+
+void PurityAnalysis::analyze(std::vector<std::shared_ptr<Stmt>> &statements) {
+  for (std::shared_ptr<Stmt> &stmt : statements) {
+    analyze(stmt);
+  }
+}
+
+void PurityAnalysis::analyze(std::shared_ptr<Stmt> &statement) {
+  std::visit(*this, *statement);
+}
+
+void PurityAnalysis::analyze(std::shared_ptr<Expr> &expr) {
+  std::visit(*this, *expr);
+}
@@ -9,7 +9,7 @@
 
 extern ErrorReporter errorReporter;
 
-size_t Resolver::counter = 0;
+std::atomic<size_t> Resolver::counter = 0;
 
 Resolver::Resolver(Interpreter &interpreter) : interpreter(interpreter) {}
 
@@ -57,6 +57,9 @@ void Resolver::operator()(Return &stmt) {
 
   if (stmt.value)
     resolve(stmt.value);
+
+  stmt.tailCall = currentFunction == FUNCTION && stmt.value != nullptr &&
+                  std::holds_alternative<Call>(*stmt.value);
 }
 
 void Resolver::operator()(While &stmt) {
@@ -113,6 +116,23 @@ void Resolver::operator()(Set &expr) {
   resolve(expr.object);
 }
 
+void Resolver::operator()(ListLiteral &expr) {
+  for (std::shared_ptr<Expr> element : expr.elements) {
+    resolve(element);
+  }
+}
+
+void Resolver::operator()(Index &expr) {
+  resolve(expr.object);
+  resolve(expr.index);
+}
+
+void Resolver::operator()(SetIndex &expr) {
+  resolve(expr.value);
+  resolve(expr.object);
+  resolve(expr.index);
+}
+
 void Resolver::operator()(Literal &expr) { expr.id = counter++; }
 
 void Resolver::operator()(Logical &expr) {
@@ -8,3 +8,7 @@ RuntimeError::RuntimeError(Token token, std::string message)
   this->token = token;
   this->message = message;
 }
+
+NativeError::NativeError(std::string message) : std::runtime_error(message) {
+  this->message = message;
+}
@@ -1,6 +1,7 @@
 #include "scanner.hpp"
 #include "error_reporter.hpp"
 #include "lox_callable.hpp"
+#include "lox_string.hpp"
 #include "token_type.hpp"
 #include <memory>
 #include <variant>
@@ -41,6 +42,12 @@ void Scanner::scanToken() {
   case '}':
     addToken(TokenType::RIGHT_BRACE);
     break;
+  case '[':
+    addToken(TokenType::LEFT_BRACKET);
+    break;
+  case ']':
+    addToken(TokenType::RIGHT_BRACKET);
+    break;
   case ',':
     addToken(TokenType::COMMA);
     break;
@@ -160,7 +167,7 @@ void Scanner::consumeString() {
   advance();
 
   std::string value = source.substr(start + 1, current - (start + 1) - 1);
-  addToken(TokenType::STRING, value);
+  addToken(TokenType::STRING, std::make_shared<LoxString>(std::move(value)));
 }
 
 void Scanner::consumeNumber() {
@@ -191,6 +198,7 @@ void Scanner::consumeIdentifier() {
 
   if (type == TokenType::TRUE || type == TokenType::FALSE) {
     addToken(type, type == TokenType::TRUE ? true : false);
+    return;
   }
 
   addToken(type);
@@ -0,0 +1,318 @@
+#include "server.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef __unix__
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#ifdef __unix__
+
+// Requests are a 4-byte length and that many bytes: the working directory
+// and then each argument, each followed by a NUL. The client's stdin,
+// stdout and stderr travel with the length as SCM_RIGHTS. The reply is the
+// exit status as a 4-byte int.
+constexpr int STREAMS = 3;
+
+static volatile std::sig_atomic_t stopping = 0;
+
+static void stop(int) { stopping = 1; }
+
+static bool address(const std::string &path, sockaddr_un &addr) {
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+
+  if (path.size() >= sizeof(addr.sun_path)) {
+    std::cerr << "Socket path too long: " << path << ".\n";
+    return false;
+  }
+
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+static bool isSocket(const std::string &path) {
+  struct stat status;
+  return lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode);
+}
+
+// MSG_NOSIGNAL: a peer that went away is an error here, not SIGPIPE.
+static bool sendAll(int fd, const char *data, size_t size) {
+  while (size > 0) {
+    ssize_t count = send(fd, data, size, MSG_NOSIGNAL);
+
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return false;
+
+    data += count;
+    size -= count;
+  }
+
+  return true;
+}
+
+static bool receiveAll(int fd, char *data, size_t size) {
+  while (size > 0) {
+    ssize_t count = recv(fd, data, size, 0);
+
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return false;
+
+    data += count;
+    size -= count;
+  }
+
+  return true;
+}
+
+// Reads a request into args, with the working directory first, and the
+// client's streams into streams.
+static bool receive(int connection, std::vector<std::string> &args,
+                    int streams[STREAMS]) {
+  uint32_t length = 0;
+  iovec data{&length, sizeof(length)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * STREAMS)];
+
+  msghdr message{};
+  message.msg_iov = &data;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  ssize_t count;
+
+  do {
+    count = recvmsg(connection, &message, 0);
+  } while (count < 0 && errno == EINTR);
+
+  cmsghdr *header = CMSG_FIRSTHDR(&message);
+
+  if (count != sizeof(length) || header == nullptr ||
+      header->cmsg_type != SCM_RIGHTS ||
+      header->cmsg_len != CMSG_LEN(sizeof(int) * STREAMS))
+    return false;
+
+  std::memcpy(streams, CMSG_DATA(header), sizeof(int) * STREAMS);
+
+  std::string payload(length, '\0');
+
+  if (!receiveAll(connection, payload.data(), length))
+    return false;
+
+  for (size_t start = 0; start < payload.size();) {
+    size_t end = payload.find('\0', start);
+
+    if (end == std::string::npos)
+      return false;
+
+    args.push_back(payload.substr(start, end - start));
+    start = end + 1;
+  }
+
+  return !args.empty();
+}
+
+[[noreturn]] static void handle(int connection, const RequestHandler &handler) {
+  std::signal(SIGCHLD, SIG_DFL);
+  std::signal(SIGINT, SIG_DFL);
+  std::signal(SIGTERM, SIG_DFL);
+
+  std::vector<std::string> args{};
+  int streams[STREAMS];
+
+  if (!receive(connection, args, streams))
+    _exit(EXIT_FAILURE);
+
+  for (int i = 0; i < STREAMS; i++) {
+    dup2(streams[i], i);
+    ::close(streams[i]);
+  }
+
+  int32_t status = EXIT_FAILURE;
+
+  if (chdir(args[0].c_str()) != 0) {
+    std::cerr << "Can't change to " << args[0] << ": "
+              << std::strerror(errno) << ".\n";
+  } else {
+    args.erase(args.begin());
+    status = handler(args);
+  }
+
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(nullptr);
+
+  sendAll(connection, reinterpret_cast<const char *>(&status),
+           sizeof(status));
+  _exit(status);
+}
+
+int serve(const std::string &socketPath, const RequestHandler &handler) {
+  sockaddr_un addr;
+
+  if (!address(socketPath, addr))
+    return EXIT_FAILURE;
+
+  // A socket file left by a server that didn't shut down cleanly would
+  // make bind() fail. Anything else at the path is somebody's file.
+  struct stat status;
+
+  if (lstat(socketPath.c_str(), &status) == 0) {
+    if (!S_ISSOCK(status.st_mode)) {
+      std::cerr << "Can't listen on " << socketPath << ": not a socket.\n";
+      return EXIT_FAILURE;
+    }
+
+    ::unlink(socketPath.c_str());
+  }
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      listen(listener, SOMAXCONN) != 0) {
+    std::cerr << "Can't listen on " << socketPath << ": "
+              << std::strerror(errno) << ".\n";
+    return EXIT_FAILURE;
+  }
+
+#ifdef __GLIBC__
+  // Setup (a prelude in particular) leaves freed chunks all over the heap.
+  // Left in place, the first large allocation in every child coalesces
+  // them, a copy-on-write fault per page; merged here, it happens once.
+  malloc_trim(0);
+#endif
+
+  // Children report to their clients, so nobody waits for them.
+  std::signal(SIGCHLD, SIG_IGN);
+
+  // Without SA_RESTART, so a signal interrupts accept().
+  struct sigaction action {};
+  action.sa_handler = stop;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+
+  while (!stopping) {
+    int connection = accept(listener, nullptr, nullptr);
+
+    if (connection < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+
+      std::cerr << "Accept failed: " << std::strerror(errno) << ".\n";
+      break;
+    }
+
+    pid_t child = fork();
+
+    if (child == 0) {
+      ::close(listener);
+      handle(connection, handler);
+    }
+
+    if (child < 0)
+      std::cerr << "Fork failed: " << std::strerror(errno) << ".\n";
+
+    ::close(connection);
+  }
+
+  ::close(listener);
+
+  // Unless something else has taken the path since.
+  if (isSocket(socketPath))
+    ::unlink(socketPath.c_str());
+
+  return EXIT_SUCCESS;
+}
+
+int connectAndRun(const std::string &socketPath,
+                  const std::vector<std::string> &args) {
+  sockaddr_un addr;
+
+  if (!address(socketPath, addr))
+    return EXIT_FAILURE;
+
+  int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (connection < 0 ||
+      connect(connection, reinterpret_cast<sockaddr *>(&addr),
+              sizeof(addr)) != 0) {
+    std::cerr << "Can't connect to " << socketPath << ": "
+              << std::strerror(errno) << ".\n";
+    return EXIT_FAILURE;
+  }
+
+  char *cwd = getcwd(nullptr, 0);
+  std::string payload = cwd != nullptr ? cwd : ".";
+  payload += '\0';
+  std::free(cwd);
+
+  for (const std::string &arg : args) {
+    payload += arg;
+    payload += '\0';
+  }
+
+  uint32_t length = payload.size();
+  iovec data{&length, sizeof(length)};
+  int streams[STREAMS] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(streams))];
+  std::memset(control, 0, sizeof(control));
+
+  msghdr message{};
+  message.msg_iov = &data;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  cmsghdr *header = CMSG_FIRSTHDR(&message);
+  header->cmsg_level = SOL_SOCKET;
+  header->cmsg_type = SCM_RIGHTS;
+  header->cmsg_len = CMSG_LEN(sizeof(streams));
+  std::memcpy(CMSG_DATA(header), streams, sizeof(streams));
+
+  int32_t status = EXIT_FAILURE;
+
+  if (sendmsg(connection, &message, MSG_NOSIGNAL) != sizeof(length) ||
+      !sendAll(connection, payload.data(), payload.size())) {
+    std::cerr << "Can't send request: " << std::strerror(errno) << ".\n";
+  } else if (!receiveAll(connection, reinterpret_cast<char *>(&status),
+                      sizeof(status))) {
+    std::cerr << "Server closed the connection before the script "
+                 "finished.\n";
+    status = EXIT_FAILURE;
+  }
+
+  ::close(connection);
+  return status;
+}
+
+#else
+
+int serve(const std::string &socketPath, const RequestHandler &handler) {
+  std::cerr << "--serve needs Unix domain sockets.\n";
+  return EXIT_FAILURE;
+}
+
+int connectAndRun(const std::string &socketPath,
+                  const std::vector<std::string> &args) {
+  std::cerr << "--connect needs Unix domain sockets.\n";
+  return EXIT_FAILURE;
+}
+
+#endif
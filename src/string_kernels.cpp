@@ -0,0 +1,91 @@
+#include "string_kernels.hpp"
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+size_t findBytes(std::string_view haystack, std::string_view needle,
+                 size_t from) {
+  size_t size = haystack.size();
+  size_t length = needle.size();
+
+  if (from > size || length > size - from)
+    return std::string_view::npos;
+
+  if (length == 0)
+    return from;
+
+  const char *chars = haystack.data();
+
+  if (length == 1) {
+    const void *match = std::memchr(chars + from, needle[0], size - from);
+    return match ? static_cast<const char *>(match) - chars
+                 : std::string_view::npos;
+  }
+
+  size_t i = from;
+
+#ifdef __SSE2__
+  // Compares 16 candidate positions at once against the needle's first and
+  // last bytes, and only checks the middle where both match.
+  const __m128i first = _mm_set1_epi8(needle[0]);
+  const __m128i last = _mm_set1_epi8(needle[length - 1]);
+
+  for (; i + length - 1 + 16 <= size; i += 16) {
+    __m128i heads =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(chars + i));
+    __m128i tails = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(chars + i + length - 1));
+    int mask = _mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(heads, first), _mm_cmpeq_epi8(tails, last)));
+
+    while (mask != 0) {
+      size_t candidate = i + __builtin_ctz(mask);
+
+      if (std::memcmp(chars + candidate + 1, needle.data() + 1,
+                      length - 2) == 0)
+        return candidate;
+
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  return haystack.find(needle, i);
+}
+
+// Adds delta to the bytes from low to high, the rest are copied.
+static void shiftRange(const char *in, char *out, size_t size, char low,
+                       char high, char delta) {
+  size_t i = 0;
+
+#ifdef __SSE2__
+  // Bytes of 0x80 and up are negative as signed chars, so they never fall
+  // in an ASCII range.
+  const __m128i below = _mm_set1_epi8(low - 1);
+  const __m128i above = _mm_set1_epi8(high + 1);
+  const __m128i shift = _mm_set1_epi8(delta);
+
+  for (; i + 16 <= size; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(chunk, below),
+                                    _mm_cmplt_epi8(chunk, above));
+    chunk = _mm_add_epi8(chunk, _mm_and_si128(inRange, shift));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), chunk);
+  }
+#endif
+
+  for (; i < size; i++) {
+    char c = in[i];
+    out[i] = c >= low && c <= high ? c + delta : c;
+  }
+}
+
+void toUpperBytes(const char *in, char *out, size_t size) {
+  shiftRange(in, out, size, 'a', 'z', 'A' - 'a');
+}
+
+void toLowerBytes(const char *in, char *out, size_t size) {
+  shiftRange(in, out, size, 'A', 'Z', 'a' - 'A');
+}
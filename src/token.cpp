@@ -1,5 +1,10 @@
 #include "token.hpp"
 #include "lox_callable.hpp"
+#include "lox_list.hpp"
+#include "lox_map.hpp"
+#include "lox_string.hpp"
+#include "native_object.hpp"
+#include "number_format.hpp"
 #include "token_type.hpp"
 #include <iomanip>
 #include <iostream>
@@ -17,46 +22,90 @@ std::string StringifyLiteralVisitor::operator()(std::monostate) const {
   return "nil";
 }
 
-std::string StringifyLiteralVisitor::operator()(std::string str) const {
-  return str;
+std::string StringifyLiteralVisitor::operator()(
+    const std::shared_ptr<LoxString> &str) const {
+  return str->str();
 }
 
 std::string StringifyLiteralVisitor::operator()(double num) const {
-  return std::to_string(num);
+  char buffer[NUMBER_BUFFER_SIZE];
+  return std::string(buffer, formatNumber(num, buffer));
 }
 
 std::string StringifyLiteralVisitor::operator()(bool val) const {
-  return std::to_string(val);
+  return val ? "true" : "false";
 }
 
 std::string StringifyLiteralVisitor::operator()(
-    std::shared_ptr<LoxCallable> callable) const {
+    const std::shared_ptr<LoxCallable> &callable) const {
   return callable->toString();
 }
 
 std::string StringifyLiteralVisitor::operator()(
-    std::shared_ptr<LoxInstance> instance) const {
+    const std::shared_ptr<LoxInstance> &instance) const {
   return instance->toString();
 }
 
+std::string StringifyLiteralVisitor::operator()(
+    const std::shared_ptr<LoxList> &list) const {
+  return list->toString();
+}
+
+std::string StringifyLiteralVisitor::operator()(
+    const std::shared_ptr<LoxMap> &map) const {
+  return map->toString();
+}
+
+std::string StringifyLiteralVisitor::operator()(
+    const std::shared_ptr<NativeObject> &object) const {
+  return object->toString();
+}
+
 bool TruthyLiteralVisitor::operator()(std::monostate) const { return false; }
 
-bool TruthyLiteralVisitor::operator()(std::string str) const { return true; }
+bool TruthyLiteralVisitor::operator()(
+    const std::shared_ptr<LoxString> &str) const {
+  return true;
+}
 
 bool TruthyLiteralVisitor::operator()(double num) const { return true; }
 
 bool TruthyLiteralVisitor::operator()(bool val) const { return val; }
 
 bool TruthyLiteralVisitor::operator()(
-    std::shared_ptr<LoxCallable> callable) const {
+    const std::shared_ptr<LoxCallable> &callable) const {
+  return true;
+}
+
+bool TruthyLiteralVisitor::operator()(
+    const std::shared_ptr<LoxInstance> &instance) const {
+  return true;
+}
+
+bool TruthyLiteralVisitor::operator()(
+    const std::shared_ptr<LoxList> &list) const {
   return true;
 }
 
 bool TruthyLiteralVisitor::operator()(
-    std::shared_ptr<LoxInstance> instance) const {
+    const std::shared_ptr<LoxMap> &map) const {
   return true;
 }
 
+bool TruthyLiteralVisitor::operator()(
+    const std::shared_ptr<NativeObject> &object) const {
+  return true;
+}
+
+bool isEqual(const LiteralObject &a, const LiteralObject &b) {
+  if (std::holds_alternative<std::shared_ptr<LoxString>>(a) &&
+      std::holds_alternative<std::shared_ptr<LoxString>>(b))
+    return *std::get<std::shared_ptr<LoxString>>(a) ==
+           *std::get<std::shared_ptr<LoxString>>(b);
+
+  return a == b;
+}
+
 std::string Token::toString() const {
   std::ostringstream oss{};
 
@@ -0,0 +1,363 @@
+#include "type_inference.hpp"
+#include "lox_string.hpp"
+#include <iomanip>
+#include <memory>
+#include <variant>
+
+TypeInference::TypeInference(Interpreter &interpreter)
+    : interpreter(interpreter) {}
+
+std::string TypeInference::name() const { return "type-inference"; }
+
+void TypeInference::run(std::vector<std::shared_ptr<Stmt>> &statements) {
+  analyze(statements);
+}
+
+void TypeInference::report(std::ostream &out) const {
+  double percent =
+      operatorNodes == 0 ? 0 : 100.0 * provenNodes / operatorNodes;
+
+  out << "type inference: " << provenNodes << " of " << operatorNodes
+      << " operator nodes proven (" << std::fixed << std::setprecision(1)
+      << percent << "%)\n";
+}
+
+// Statements
+
+void TypeInference::operator()(Block &stmt) {
+  scopes.push_back(Scope{});
+  analyze(stmt.statements);
+  scopes.pop_back();
+}
+
+void TypeInference::operator()(Class &stmt) {
+  declare(stmt.name.lexeme, StaticType::UNKNOWN);
+}
+
+void TypeInference::operator()(Expression &stmt) { analyze(stmt.expr); }
+
+void TypeInference::operator()(Func &stmt) {
+  declare(stmt.name.lexeme, StaticType::UNKNOWN);
+
+  size_t enclosingBase = functionBase;
+  functionBase = scopes.size();
+  scopes.push_back(Scope{});
+
+  for (Token &param : stmt.params) {
+    declare(param.lexeme, StaticType::UNKNOWN);
+  }
+
+  analyze(stmt.body);
+
+  scopes.pop_back();
+  functionBase = enclosingBase;
+}
+
+void TypeInference::operator()(If &stmt) {
+  analyze(stmt.condition);
+
+  std::vector<Scope> before = scopes;
+  analyze(stmt.thenBranch);
+  std::vector<Scope> afterThen = scopes;
+
+  scopes = before;
+  if (stmt.elseBranch != nullptr)
+    analyze(stmt.elseBranch);
+
+  scopes = join(afterThen, scopes);
+}
+
+void TypeInference::operator()(Print &stmt) { analyze(stmt.expr); }
+
+void TypeInference::operator()(Return &stmt) {
+  if (stmt.value != nullptr)
+    analyze(stmt.value);
+}
+
+void TypeInference::operator()(Var &stmt) {
+  StaticType type = StaticType::NIL;
+
+  if (stmt.initializer != nullptr)
+    type = analyze(stmt.initializer);
+
+  declare(stmt.name.lexeme, type);
+}
+
+void TypeInference::operator()(While &stmt) {
+  bool enclosingMarking = marking;
+  marking = false;
+
+  std::vector<Scope> entry = scopes;
+
+  while (true) {
+    analyze(stmt.condition);
+    analyze(stmt.body);
+
+    std::vector<Scope> next = join(entry, scopes);
+    if (sameState(next, entry))
+      break;
+
+    entry = next;
+    scopes = entry;
+  }
+
+  marking = enclosingMarking;
+
+  scopes = entry;
+  analyze(stmt.condition);
+  std::vector<Scope> exit = scopes;
+  analyze(stmt.body);
+
+  scopes = exit;
+}
+
+// Expressions
+
+StaticType TypeInference::operator()(Assign &expr) {
+  StaticType type = analyze(expr.value);
+  assign(expr.id, expr.name.lexeme, type);
+  return type;
+}
+
+StaticType TypeInference::operator()(Logical &expr) {
+  StaticType left = analyze(expr.left);
+
+  std::vector<Scope> before = scopes;
+  StaticType right = analyze(expr.right);
+  scopes = join(before, scopes);
+
+  return join(left, right);
+}
+
+StaticType TypeInference::operator()(Binary &expr) {
+  StaticType left = analyze(expr.left);
+  StaticType right = analyze(expr.right);
+
+  bool numbers = left == StaticType::NUMBER && right == StaticType::NUMBER;
+  StaticType proven = numbers ? StaticType::NUMBER : StaticType::UNKNOWN;
+  StaticType result = StaticType::BOOLEAN;
+
+  switch (expr.op.type) {
+  case TokenType::PLUS:
+    if (left == StaticType::STRING && right == StaticType::STRING)
+      proven = StaticType::STRING;
+
+    // Anything else is a runtime error, so one known side fixes the result.
+    if (left == StaticType::NUMBER || right == StaticType::NUMBER)
+      result = StaticType::NUMBER;
+    else if (left == StaticType::STRING || right == StaticType::STRING)
+      result = StaticType::STRING;
+    else
+      result = StaticType::UNKNOWN;
+    break;
+
+  case TokenType::MINUS:
+  case TokenType::STAR:
+  case TokenType::SLASH:
+    result = StaticType::NUMBER;
+    break;
+
+  default:
+    break;
+  }
+
+  mark(expr.operandType, proven);
+
+  return result;
+}
+
+StaticType TypeInference::operator()(Call &expr) {
+  analyze(expr.callee);
+
+  for (std::shared_ptr<Expr> &arg : expr.args) {
+    analyze(arg);
+  }
+
+  return StaticType::UNKNOWN;
+}
+
+StaticType TypeInference::operator()(Get &expr) {
+  analyze(expr.object);
+  return StaticType::UNKNOWN;
+}
+
+StaticType TypeInference::operator()(Set &expr) {
+  analyze(expr.object);
+  analyze(expr.value);
+  return StaticType::UNKNOWN;
+}
+
+StaticType TypeInference::operator()(Grouping &expr) {
+  return analyze(expr.expression);
+}
+
+StaticType TypeInference::operator()(Literal &expr) {
+  if (std::holds_alternative<double>(expr.value))
+    return StaticType::NUMBER;
+  if (std::holds_alternative<std::shared_ptr<LoxString>>(expr.value))
+    return StaticType::STRING;
+  if (std::holds_alternative<bool>(expr.value))
+    return StaticType::BOOLEAN;
+  if (std::holds_alternative<std::monostate>(expr.value))
+    return StaticType::NIL;
+
+  return StaticType::UNKNOWN;
+}
+
+StaticType TypeInference::operator()(Unary &expr) {
+  StaticType right = analyze(expr.right);
+
+  if (expr.op.type == TokenType::BANG)
+    return StaticType::BOOLEAN;
+
+  mark(expr.operandType, right == StaticType::NUMBER ? StaticType::NUMBER
+                                                     : StaticType::UNKNOWN);
+
+  return StaticType::NUMBER;
+}
+
+StaticType TypeInference::operator()(Variable &expr) {
+  return lookup(expr.id, expr.name.lexeme);
+}
+
+StaticType TypeInference::operator()(ListLiteral &expr) {
+  for (std::shared_ptr<Expr> &element : expr.elements) {
+    analyze(element);
+  }
+
+  return StaticType::UNKNOWN;
+}
+
+StaticType TypeInference::operator()(Index &expr) {
+  analyze(expr.object);
+  analyze(expr.index);
+  return StaticType::UNKNOWN;
+}
+
+StaticType TypeInference::operator()(SetIndex &expr) {
+  analyze(expr.object);
+  analyze(expr.index);
+  analyze(expr.value);
+  return StaticType::UNKNOWN;
+}
+
+// Helpers
+
+void TypeInference::analyze(std::vector<std::shared_ptr<Stmt>> &statements) {
+  for (std::shared_ptr<Stmt> &stmt : statements) {
+    analyze(stmt);
+  }
+}
+
+void TypeInference::analyze(std::shared_ptr<Stmt> statement) {
+  std::visit(*this, *statement);
+}
+
+StaticType TypeInference::analyze(std::shared_ptr<Expr> expr) {
+  return std::visit(*this, *expr);
+}
+
+int TypeInference::scopeIndex(const std::optional<size_t> &id) {
+  if (!id.has_value() || !interpreter.locals.count(id.value()))
+    return -1;
+
+  int index = scopes.size() - 1 - interpreter.locals[id.value()];
+  return index < 0 ? -1 : index;
+}
+
+StaticType TypeInference::lookup(const std::optional<size_t> &id,
+                                 const std::string &name) {
+  int index = scopeIndex(id);
+
+  // Globals, and locals captured from an enclosing function, can change
+  // behind our back.
+  if (index < static_cast<int>(functionBase))
+    return StaticType::UNKNOWN;
+
+  auto var = scopes[index].find(name);
+  if (var == scopes[index].end() || var->second.pinned)
+    return StaticType::UNKNOWN;
+
+  return var->second.type;
+}
+
+void TypeInference::assign(const std::optional<size_t> &id,
+                           const std::string &name, StaticType type) {
+  int index = scopeIndex(id);
+
+  if (index < 0)
+    return;
+
+  if (index < static_cast<int>(functionBase)) {
+    scopes[index][name] = VarState{StaticType::UNKNOWN, true};
+    return;
+  }
+
+  VarState &var = scopes[index][name];
+  var.type = var.pinned ? StaticType::UNKNOWN : type;
+}
+
+void TypeInference::declare(const std::string &name, StaticType type) {
+  if (scopes.empty())
+    return;
+
+  scopes.back()[name] = VarState{type, false};
+}
+
+void TypeInference::mark(StaticType &operandType, StaticType proven) {
+  if (!marking)
+    return;
+
+  operandType = proven;
+  operatorNodes++;
+
+  if (proven != StaticType::UNKNOWN)
+    provenNodes++;
+}
+
+StaticType TypeInference::join(StaticType a, StaticType b) {
+  return a == b ? a : StaticType::UNKNOWN;
+}
+
+std::vector<TypeInference::Scope>
+TypeInference::join(const std::vector<Scope> &a, const std::vector<Scope> &b) {
+  std::vector<Scope> joined = a;
+
+  for (size_t i = 0; i < joined.size(); i++) {
+    for (auto &[name, var] : joined[i]) {
+      auto other = b[i].find(name);
+
+      if (other == b[i].end()) {
+        var.type = StaticType::UNKNOWN;
+      } else {
+        var.type = join(var.type, other->second.type);
+        var.pinned = var.pinned || other->second.pinned;
+      }
+    }
+
+    for (const auto &[name, var] : b[i]) {
+      if (!joined[i].count(name))
+        joined[i][name] = VarState{StaticType::UNKNOWN, var.pinned};
+    }
+  }
+
+  return joined;
+}
+
+bool TypeInference::sameState(const std::vector<Scope> &a,
+                              const std::vector<Scope> &b) {
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].size() != b[i].size())
+      return false;
+
+    for (const auto &[name, var] : a[i]) {
+      auto other = b[i].find(name);
+
+      if (other == b[i].end() || other->second.type != var.type ||
+          other->second.pinned != var.pinned)
+        return false;
+    }
+  }
+
+  return true;
+}